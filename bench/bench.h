@@ -0,0 +1,48 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <chrono>
+
+#include "../src/stream.h"
+#include "../src/test.h"
+
+
+namespace abc { namespace bench {
+
+	using log_line = abc::test_line_ostream<>;
+	using log_filter = abc::log_filter;
+	using log = abc::log_ostream<log_line, log_filter>;
+
+	using clock = std::chrono::steady_clock;
+
+
+	inline long long elapsed_us(clock::time_point start, clock::time_point end = clock::now()) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+	}
+
+}}
@@ -0,0 +1,165 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include <cstring>
+
+#include "../src/buffer_streambuf.h"
+#include "../src/scan.h"
+
+#include "http.h"
+
+
+namespace abc { namespace bench { namespace http {
+
+	constexpr std::size_t request_round_count = 100000;
+
+
+	// The request corpora from test/http.cpp.
+	static const char extraspaces_request[] =
+		"GET   http://a.com/b?c=d    HTTP/12.345  \r\n"
+		"Name:Value\r\n"
+		"Multi_Word-Name:  Value  with   spaces   inside \t \r\n"
+		"Trailing-Spaces:  3 spaces   \r\n"
+		"\r\n";
+
+	static const char realworld_request[] =
+		"GET https://en.cppreference.com/w/cpp/io/basic_streambuf HTTP/1.1\r\n"
+		"Host: en.cppreference.com\r\n"
+		"User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:76.0) Gecko/20100101 Firefox/76.0\r\n"
+		"Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;q=0.8\r\n"
+		"Accept-Language: en-US,en;q=0.5\r\n"
+		"Accept-Encoding: gzip, deflate, br\r\n"
+		"Connection: keep-alive\r\n"
+		"Cookie: __utma=165123437.761011328.1578550293.1590821219.1590875063.126; __utmz=165123437.1581492299.50.2.utmcsr=bing|utmccn=(organic)|utmcmd=organic|utmctr=(not%20provided); _bsap_daycap=407621%2C407621%2C408072%2C408072%2C408072%2C408072; _bsap_lifecap=407621%2C407621%2C408072%2C408072%2C408072%2C408072; __utmc=165123437\r\n"
+		"Upgrade-Insecure-Requests: 1\r\n"
+		"Cache-Control: max-age=0\r\n"
+		"\r\n";
+
+
+	// Reads the whole head item by item, copying each item into a buffer.
+	static std::size_t run_istream(const char* request, std::size_t request_size) {
+		char buffer[abc::size::k1];
+		std::size_t item_count = 0;
+
+		for (std::size_t r = 0; r < request_round_count; r++) {
+			abc::buffer_streambuf sb(const_cast<char*>(request), 0, request_size, nullptr, 0, 0);
+			abc::http_request_istream<> istream(&sb);
+
+			istream.get_method(buffer, sizeof(buffer));
+			istream.get_resource(buffer, sizeof(buffer));
+			istream.get_protocol(buffer, sizeof(buffer));
+			item_count += 3;
+
+			while (istream.good()) {
+				istream.get_header_name(buffer, sizeof(buffer));
+				if (istream.gcount() == 0) {
+					break;
+				}
+
+				istream.get_header_value(buffer, sizeof(buffer));
+				item_count += 2;
+			}
+		}
+
+		return item_count;
+	}
+
+
+	// Parses the whole head in place.
+	static std::size_t run_parser(const char* request, std::size_t request_size) {
+		abc::http_request_parser<> parser;
+		std::size_t item_count = 0;
+
+		for (std::size_t r = 0; r < request_round_count; r++) {
+			parser.reset();
+
+			if (parser.parse(request, request_size) == abc::http::parse_status::done) {
+				item_count += 3 + 2 * parser.header_count();
+			}
+		}
+
+		return item_count;
+	}
+
+
+	static void bench_request(test_context<abc::bench::log>& context, const char* corpus, const char* request, const char* name, bool is_parser, tag_t tag) {
+		std::size_t request_size = std::strlen(request);
+
+		clock::time_point start = clock::now();
+		std::size_t item_count = is_parser ? run_parser(request, request_size) : run_istream(request, request_size);
+		long long us = elapsed_us(start);
+
+		context.log->put_any(abc::category::any, abc::severity::important, tag, "%-12s %-8s requests=%zu, items=%zu, total=%lld us, per request=%.3f us, per byte=%.2f ns",
+			corpus, name, request_round_count, item_count, us, (double)us / request_round_count, 1000.0 * us / (request_round_count * request_size));
+	}
+
+
+	bool bench_http_request_istream_vs_parser(test_context<abc::bench::log>& context) {
+		bench_request(context, "extraspaces", extraspaces_request, "istream", false, 0x1048d);
+		bench_request(context, "extraspaces", extraspaces_request, "parser", true, 0x1048e);
+		bench_request(context, "realworld", realworld_request, "istream", false, 0x1048f);
+		bench_request(context, "realworld", realworld_request, "parser", true, 0x10490);
+
+		return true;
+	}
+
+
+
+	static void bench_kernel(test_context<abc::bench::log>& context, abc::scan::kernel_t kernel, const char* name, tag_t tag) {
+		if (kernel > abc::scan::supported_kernel()) {
+			context.log->put_any(abc::category::any, abc::severity::important, tag, "%-8s not supported", name);
+			return;
+		}
+
+		abc::scan::set_kernel(kernel);
+		std::size_t request_size = std::strlen(realworld_request);
+
+		clock::time_point start = clock::now();
+		run_parser(realworld_request, request_size);
+		long long parser_us = elapsed_us(start);
+
+		start = clock::now();
+		run_istream(realworld_request, request_size);
+		long long istream_us = elapsed_us(start);
+
+		context.log->put_any(abc::category::any, abc::severity::important, tag, "%-8s requests=%zu, parser per request=%.3f us, istream per request=%.3f us",
+			name, request_round_count, (double)parser_us / request_round_count, (double)istream_us / request_round_count);
+	}
+
+
+	bool bench_http_scan_kernels(test_context<abc::bench::log>& context) {
+		abc::scan::kernel_t supported_kernel = abc::scan::supported_kernel();
+
+		bench_kernel(context, abc::scan::kernel::scalar, "scalar", 0x10493);
+		bench_kernel(context, abc::scan::kernel::sse2, "sse2", 0x10494);
+		bench_kernel(context, abc::scan::kernel::avx2, "avx2", 0x10495);
+
+		abc::scan::set_kernel(supported_kernel);
+
+		return true;
+	}
+
+}}}
@@ -0,0 +1,56 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include <iostream>
+
+#include "bench.h"
+#include "socket.h"
+#include "http.h"
+
+
+int main() {
+	abc::bench::log_filter filter(abc::severity::important);
+	abc::bench::log log(std::cout.rdbuf(), &filter);
+
+	abc::test_suite<abc::bench::log> bench_suite( {
+			{ "socket", {
+				{ "bench_tcp_blocking_vs_uring",					abc::bench::socket::bench_tcp_blocking_vs_uring },
+				{ "bench_udp_single_vs_batch",						abc::bench::socket::bench_udp_single_vs_batch },
+				{ "bench_tcp_accept_reuse_port",					abc::bench::socket::bench_tcp_accept_reuse_port },
+				{ "bench_local_vs_tcp_latency",						abc::bench::socket::bench_local_vs_tcp_latency },
+			} },
+			{ "http", {
+				{ "bench_http_request_istream_vs_parser",			abc::bench::http::bench_http_request_istream_vs_parser },
+				{ "bench_http_scan_kernels",						abc::bench::http::bench_http_scan_kernels },
+			} },
+		},
+		&log,
+		0);
+
+	bool passed = bench_suite.run();
+
+	return passed ? 0 : 1;
+}
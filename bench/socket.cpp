@@ -0,0 +1,417 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include <thread>
+#include <optional>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+
+#include "../src/uring.h"
+#include "../src/endpoint.h"
+
+#include "socket.h"
+
+
+namespace abc { namespace bench { namespace socket {
+
+	constexpr std::size_t connection_count	= 32;
+	constexpr std::size_t round_count		= 2000;
+	constexpr std::size_t message_size		= 64;
+
+	using server_connections = std::optional<abc::tcp_client_socket<abc::bench::log>>[connection_count];
+
+
+	// Each round, the client sends a message over every connection, and then it receives the echo from every connection.
+	static void run_client(const char* port) {
+		abc::tcp_client_socket<abc::bench::log> clients[connection_count];
+		for (std::size_t c = 0; c < connection_count; c++) {
+			clients[c].connect("localhost", port);
+		}
+
+		char message[message_size];
+		std::memset(message, 'x', sizeof(message));
+
+		for (std::size_t r = 0; r < round_count; r++) {
+			for (std::size_t c = 0; c < connection_count; c++) {
+				clients[c].send(message, sizeof(message));
+			}
+
+			for (std::size_t c = 0; c < connection_count; c++) {
+				clients[c].receive(message, sizeof(message));
+			}
+		}
+	}
+
+
+	// Two syscalls per connection per round.
+	static std::size_t run_blocking_server(server_connections& connections) {
+		char messages[connection_count][message_size];
+		std::size_t syscall_count = 0;
+
+		for (std::size_t r = 0; r < round_count; r++) {
+			for (std::size_t c = 0; c < connection_count; c++) {
+				connections[c]->receive(messages[c], message_size);
+				syscall_count++;
+			}
+
+			for (std::size_t c = 0; c < connection_count; c++) {
+				connections[c]->send(messages[c], message_size);
+				syscall_count++;
+			}
+		}
+
+		return syscall_count;
+	}
+
+
+	// Two syscalls per round regardless of the number of connections, unless a receive completes partially.
+	static std::size_t run_uring_server(server_connections& connections) {
+		abc::uring<connection_count, abc::bench::log> ring;
+		abc::uring_completion completion;
+		char messages[connection_count][message_size];
+		std::size_t syscall_count = 0;
+
+		for (std::size_t r = 0; r < round_count; r++) {
+			for (std::size_t c = 0; c < connection_count; c++) {
+				connections[c]->prepare_receive(ring, messages[c], message_size, c);
+			}
+
+			ring.submit(connection_count);
+			syscall_count++;
+
+			for (std::size_t done = 0; done < connection_count; ) {
+				while (ring.get_completion(completion)) {
+					std::size_t c = completion.user_data;
+					if (completion.result < (std::int32_t)message_size) {
+						connections[c]->receive(messages[c] + completion.result, message_size - completion.result);
+						syscall_count++;
+					}
+
+					done++;
+				}
+
+				if (done < connection_count) {
+					ring.submit(1);
+					syscall_count++;
+				}
+			}
+
+			for (std::size_t c = 0; c < connection_count; c++) {
+				connections[c]->prepare_send(ring, messages[c], message_size, c);
+			}
+
+			ring.submit(connection_count);
+			syscall_count++;
+
+			while (ring.get_completion(completion)) {
+			}
+		}
+
+		return syscall_count;
+	}
+
+
+	template <typename Server>
+	static void bench_server(test_context<abc::bench::log>& context, const char* port, const char* name, Server&& server, tag_t tag) {
+		abc::tcp_server_socket<abc::bench::log> listener;
+		listener.bind(port);
+		listener.listen(connection_count);
+
+		std::thread client_thread(run_client, port);
+
+		server_connections connections;
+		for (std::size_t c = 0; c < connection_count; c++) {
+			connections[c].emplace(listener.accept());
+		}
+
+		clock::time_point start = clock::now();
+		std::size_t syscall_count = server(connections);
+		long long us = elapsed_us(start);
+
+		client_thread.join();
+
+		context.log->put_any(abc::category::any, abc::severity::important, tag, "%-10s connections=%zu, rounds=%zu, total=%lld us, per round=%.2f us, server syscalls per round=%.2f",
+			name, connection_count, round_count, us, (double)us / round_count, (double)syscall_count / round_count);
+	}
+
+
+	bool bench_tcp_blocking_vs_uring(test_context<abc::bench::log>& context) {
+		bench_server(context, "31300", "blocking", run_blocking_server, 0x1037f);
+		bench_server(context, "31301", "io_uring", run_uring_server, 0x10380);
+
+		return true;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	constexpr std::size_t datagram_count	= 64;
+	constexpr std::size_t udp_round_count	= 2000;
+
+
+	// Each round, the client sends a burst of datagrams, and then it waits for a one-byte acknowledgement, so that nothing gets dropped.
+	static void run_udp_client(const char* port, bool is_batch) {
+		abc::udp_socket<abc::bench::log> client;
+		client.connect("localhost", port);
+
+		char datagrams[datagram_count][message_size];
+		std::memset(datagrams, 'x', sizeof(datagrams));
+
+		iovec vector[datagram_count];
+		for (std::size_t i = 0; i < datagram_count; i++) {
+			vector[i].iov_base = datagrams[i];
+			vector[i].iov_len = message_size;
+		}
+
+		for (std::size_t r = 0; r < udp_round_count; r++) {
+			if (is_batch) {
+				client.send_batch(vector, datagram_count);
+			}
+			else {
+				for (std::size_t i = 0; i < datagram_count; i++) {
+					client.send(datagrams[i], message_size);
+				}
+			}
+
+			char ack;
+			client.receive(&ack, sizeof(ack));
+		}
+	}
+
+
+	static void bench_udp_server(test_context<abc::bench::log>& context, const char* port, const char* name, bool is_batch, tag_t tag) {
+		abc::udp_socket<abc::bench::log> server;
+		server.bind(port);
+
+		std::thread client_thread(run_udp_client, port, is_batch);
+
+		char datagrams[datagram_count][message_size];
+		iovec vector[datagram_count];
+		std::size_t sizes[datagram_count];
+		abc::socket::address addresses[datagram_count];
+		for (std::size_t i = 0; i < datagram_count; i++) {
+			vector[i].iov_base = datagrams[i];
+			vector[i].iov_len = message_size;
+		}
+
+		std::size_t syscall_count = 0;
+		clock::time_point start = clock::now();
+
+		for (std::size_t r = 0; r < udp_round_count; r++) {
+			if (is_batch) {
+				for (std::size_t received_count = 0; received_count < datagram_count; syscall_count++) {
+					received_count += server.receive_batch(vector + received_count, sizes + received_count, datagram_count - received_count, addresses + received_count);
+				}
+			}
+			else {
+				for (std::size_t i = 0; i < datagram_count; i++, syscall_count++) {
+					server.receive(datagrams[i], message_size, &addresses[i]);
+				}
+			}
+
+			char ack = 'a';
+			server.send(&ack, sizeof(ack), &addresses[0]);
+		}
+
+		long long us = elapsed_us(start);
+
+		client_thread.join();
+
+		context.log->put_any(abc::category::any, abc::severity::important, tag, "%-10s datagrams=%zu, rounds=%zu, total=%lld us, per datagram=%.3f us, server receive syscalls per round=%.2f",
+			name, datagram_count, udp_round_count, us, (double)us / (udp_round_count * datagram_count), (double)syscall_count / udp_round_count);
+	}
+
+
+	bool bench_udp_single_vs_batch(test_context<abc::bench::log>& context) {
+		bench_udp_server(context, "31302", "single", false, 0x103ae);
+		bench_udp_server(context, "31303", "batch", true, 0x103af);
+
+		return true;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	constexpr std::size_t accept_client_count		= 4;
+	constexpr std::size_t accept_connection_count	= 1000;
+	constexpr std::size_t accept_run_count			= 3;
+
+	using bench_endpoint = abc::endpoint<abc::endpoint_limits, abc::bench::log>;
+
+
+	// Each connection carries a single request, so the endpoint's listeners accept as many connections as there are requests.
+	static void run_request_client(const char* port) {
+		static const char request[] = "GET /bench HTTP/1.1\r\nConnection: close\r\n\r\n";
+		char response[abc::size::_256];
+
+		for (std::size_t i = 0; i < accept_connection_count / accept_client_count; i++) {
+			abc::tcp_client_socket<abc::bench::log> client;
+			client.connect("localhost", port);
+			client.send(request, sizeof(request) - 1);
+
+			// Close the sending side first, so that the TIME_WAIT ends up on this side rather than on the endpoint's port.
+			::shutdown(client.handle(), SHUT_WR);
+
+			// Read until the endpoint closes the connection.
+			while (::recv(client.handle(), response, sizeof(response), 0) > 0) {
+			}
+		}
+	}
+
+
+	// A previous run may have left connections in TIME_WAIT on a port, which would fail the endpoint's bind.
+	// Pick the first port from first_port on that can still be bound.
+	static void find_free_port(unsigned first_port, char* port, std::size_t port_size) {
+		for (unsigned p = first_port; ; p++) {
+			std::snprintf(port, port_size, "%u", p);
+
+			try {
+				abc::tcp_server_socket<abc::bench::log> probe;
+				probe.bind(port);
+				return;
+			}
+			catch (const std::exception&) {
+			}
+		}
+	}
+
+
+	// The endpoint starts listening on its own thread. Keep trying to connect until it does.
+	static void wait_for_listener(const char* port) {
+		while (true) {
+			try {
+				abc::tcp_client_socket<abc::bench::log> client;
+				client.connect("localhost", port);
+				return;
+			}
+			catch (const std::exception&) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+	}
+
+
+	static void bench_accept(test_context<abc::bench::log>& context, std::size_t run, unsigned first_port, std::size_t listener_count, tag_t tag) {
+		// An endpoint never stops listening, so it has to outlive this call.
+		static char ports[accept_run_count][abc::size::_16];
+		static std::optional<abc::endpoint_config> configs[accept_run_count];
+		static std::optional<bench_endpoint> endpoints[accept_run_count];
+
+		const char* port = ports[run];
+		find_free_port(first_port, ports[run], sizeof(ports[run]));
+
+		configs[run].emplace(port, size::_128, ".", "/resources/");
+		configs[run]->listener_count = listener_count;
+		endpoints[run].emplace(&*configs[run], nullptr);
+		endpoints[run]->start_async();
+
+		wait_for_listener(port);
+
+		clock::time_point start = clock::now();
+
+		std::optional<std::thread> client_threads[accept_client_count];
+		for (std::size_t c = 0; c < accept_client_count; c++) {
+			client_threads[c].emplace(run_request_client, port);
+		}
+
+		for (std::size_t c = 0; c < accept_client_count; c++) {
+			client_threads[c]->join();
+		}
+
+		long long us = elapsed_us(start);
+
+		context.log->put_any(abc::category::any, abc::severity::important, tag, "listeners=%zu, connections=%zu, total=%lld us, connections per ms=%.2f",
+			listener_count, accept_connection_count, us, (double)accept_connection_count * 1000 / us);
+	}
+
+
+	// The listener counts are fixed, so the runs are comparable across machines. On a single core, the extra listeners only add contention.
+	bool bench_tcp_accept_reuse_port(test_context<abc::bench::log>& context) {
+		bench_accept(context, 0, 31310, 1, 0x103bc);
+		bench_accept(context, 1, 31330, 2, 0x103bd);
+		bench_accept(context, 2, 31350, 4, 0x103be);
+
+		return true;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	constexpr std::size_t ping_count = 20000;
+
+
+	static void run_echo_server(abc::tcp_server_socket<abc::bench::log>* listener) {
+		abc::tcp_client_socket<abc::bench::log> connection = listener->accept();
+
+		char message[message_size];
+		for (std::size_t p = 0; p < ping_count; p++) {
+			connection.receive(message, sizeof(message));
+			connection.send(message, sizeof(message));
+		}
+	}
+
+
+	static void bench_ping(test_context<abc::bench::log>& context, abc::socket::family_t family, const char* port, const char* name, tag_t tag) {
+		abc::tcp_server_socket<abc::bench::log> listener(family);
+		listener.bind(port);
+		listener.listen(1);
+
+		std::thread server_thread(run_echo_server, &listener);
+
+		abc::tcp_client_socket<abc::bench::log> client(family);
+		client.connect("localhost", port);
+
+		char message[message_size];
+		std::memset(message, 'x', sizeof(message));
+
+		clock::time_point start = clock::now();
+
+		for (std::size_t p = 0; p < ping_count; p++) {
+			client.send(message, sizeof(message));
+			client.receive(message, sizeof(message));
+		}
+
+		long long us = elapsed_us(start);
+
+		server_thread.join();
+
+		context.log->put_any(abc::category::any, abc::severity::important, tag, "%-10s round trips=%zu, total=%lld us, per round trip=%.2f us",
+			name, ping_count, us, (double)us / ping_count);
+	}
+
+
+	bool bench_local_vs_tcp_latency(test_context<abc::bench::log>& context) {
+		bench_ping(context, abc::socket::family::ipv4, "31307", "tcp", 0x103e8);
+		bench_ping(context, abc::socket::family::local, "@abc_bench_local", "local", 0x103e9);
+
+		return true;
+	}
+
+}}}
@@ -25,15 +25,58 @@ SOFTWARE.
 
 #pragma once
 
+#include <cstddef>
+#include <algorithm>
 #include <streambuf>
 
 
 namespace abc {
 
+	// A contiguous run of buffered chars.
 	template <typename Char>
-	class basic_buffer_streambuf : public std::basic_streambuf<Char> {
+	struct basic_char_span {
+		const Char*		data;
+		std::size_t		size;
+	};
+
+
+	using char_span = basic_char_span<char>;
+	using wchar_span = basic_char_span<wchar_t>;
+
+
+	// --------------------------------------------------------------
+
+
+	// A streambuf whose get area parsers can scan in place, a whole run at a time, instead of a char at a time.
+	// peek_span() and consume() move the same read position as the std::streambuf methods, so both may be mixed.
+	template <typename Char>
+	class basic_span_streambuf : public std::basic_streambuf<Char> {
 		using base = std::basic_streambuf<Char>;
 
+	protected:
+		basic_span_streambuf() = default;
+
+	public:
+		// The chars buffered from the current read position. If there are none, the get area is refilled first.
+		// An empty span means the end of the stream.
+		basic_char_span<Char>	peek_span();
+
+		// Moves the read position past size chars. size is capped at the number of buffered chars.
+		void					consume(std::size_t size) noexcept;
+	};
+
+
+	using span_streambuf = basic_span_streambuf<char>;
+	using wspan_streambuf = basic_span_streambuf<wchar_t>;
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Char>
+	class basic_buffer_streambuf : public basic_span_streambuf<Char> {
+		using base = basic_span_streambuf<Char>;
+
 	public:
 		basic_buffer_streambuf(Char* get_buffer, std::size_t get_begin_pos, std::size_t get_end_pos, Char* put_buffer, std::size_t put_begin_pos, std::size_t put_end_pos) noexcept;
 		basic_buffer_streambuf(Char* get_begin_ptr, Char* get_end_ptr, Char* put_begin_ptr, Char* put_end_ptr) noexcept;
@@ -47,6 +90,27 @@ namespace abc {
 	// --------------------------------------------------------------
 
 
+	template <typename Char>
+	inline basic_char_span<Char> basic_span_streambuf<Char>::peek_span() {
+		// sgetc() refills the get area when it is empty.
+		if (base::gptr() == base::egptr() && base::traits_type::eq_int_type(base::sgetc(), base::traits_type::eof())) {
+			return basic_char_span<Char> { base::gptr(), 0 };
+		}
+
+		return basic_char_span<Char> { base::gptr(), static_cast<std::size_t>(base::egptr() - base::gptr()) };
+	}
+
+
+	template <typename Char>
+	inline void basic_span_streambuf<Char>::consume(std::size_t size) noexcept {
+		size = std::min(size, static_cast<std::size_t>(base::egptr() - base::gptr()));
+		base::gbump(static_cast<int>(size));
+	}
+
+
+	// --------------------------------------------------------------
+
+
 	template <typename Char>
 	inline basic_buffer_streambuf<Char>::basic_buffer_streambuf(Char* get_buffer, std::size_t get_begin_pos, std::size_t get_end_pos, Char* put_buffer, std::size_t put_begin_pos, std::size_t put_end_pos) noexcept
 		: basic_buffer_streambuf<Char>(&get_buffer[get_begin_pos], &get_buffer[get_end_pos], &put_buffer[put_begin_pos], &put_buffer[put_end_pos]) {
@@ -55,7 +119,7 @@ namespace abc {
 
 	template <typename Char>
 	inline basic_buffer_streambuf<Char>::basic_buffer_streambuf(Char* get_begin_ptr, Char* get_end_ptr, Char* put_begin_ptr, Char* put_end_ptr) noexcept
-		: std::basic_streambuf<Char>() {
+		: base() {
 		base::setg(get_begin_ptr, get_begin_ptr, get_end_ptr);
 		base::setp(put_begin_ptr, put_end_ptr);
 	}
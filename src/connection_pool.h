@@ -0,0 +1,223 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <stdexcept>
+#include <cstring>
+#include <poll.h>
+
+#include "connection_pool.i.h"
+#include "socket.h"
+#include "exception.h"
+
+
+namespace abc {
+
+	template <typename Log, std::size_t Size>
+	inline connection_pool<Log, Size>::connection_pool(Log* log)
+		: connection_pool<Log, Size>(Size, std::chrono::seconds(60), log) {
+	}
+
+
+	template <typename Log, std::size_t Size>
+	inline connection_pool<Log, Size>::connection_pool(std::size_t max_per_host, std::chrono::milliseconds max_idle, Log* log)
+		: _max_per_host(max_per_host)
+		, _max_idle(max_idle)
+		, _log(log)
+		, _hit_count(0)
+		, _miss_count(0) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::pool, severity::abc::debug, 0x103d0, "connection_pool::connection_pool() max_per_host=%zu", max_per_host);
+		}
+
+		for (slot& s : _slots) {
+			s.host[0] = '\0';
+			s.port[0] = '\0';
+			s.family = socket::family::ipv4;
+			s.is_lent = false;
+			s.lent_client = nullptr;
+		}
+	}
+
+
+	template <typename Log, std::size_t Size>
+	inline tcp_client_socket<Log>* connection_pool<Log, Size>::acquire(const char* host, const char* port, socket::family_t family) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::pool, severity::abc::debug, 0x103d1, "connection_pool::acquire() >>> %s:%s family=%d", host, port, family);
+		}
+
+		if (std::strlen(host) >= sizeof(slot::host) || std::strlen(port) >= sizeof(slot::port)) {
+			throw exception<std::logic_error, Log>("host:port", 0x103d2, _log);
+		}
+
+		slot* target = nullptr;
+		bool is_hit = false;
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			slot* empty_slot = nullptr;
+			slot* idle_slot = nullptr;
+			std::size_t host_count = 0;
+			socket::clock::time_point now = socket::clock::now();
+
+			for (slot& s : _slots) {
+				if (!s.is_lent && s.client.has_value()) {
+					bool is_match_local = is_match(s, host, port, family);
+
+					// Only the idle connection that is about to be reused is checked for liveness. The rest only for age.
+					if (now - s.idle_since > _max_idle || (is_match_local && target == nullptr && !is_alive(s))) {
+						s.client.reset();
+					}
+					else if (is_match_local && target == nullptr) {
+						target = &s;
+						continue;
+					}
+				}
+
+				if (!s.is_lent && !s.client.has_value()) {
+					if (empty_slot == nullptr) {
+						empty_slot = &s;
+					}
+				}
+				else if (is_match(s, host, port, family)) {
+					host_count++;
+				}
+				else if (!s.is_lent && (idle_slot == nullptr || s.idle_since < idle_slot->idle_since)) {
+					// The longest idle connection to another host is the one to evict if there is no empty slot.
+					idle_slot = &s;
+				}
+			}
+
+			if (target != nullptr) {
+				is_hit = true;
+				_hit_count++;
+			}
+			else if (host_count < _max_per_host && (empty_slot != nullptr || idle_slot != nullptr)) {
+				target = empty_slot != nullptr ? empty_slot : idle_slot;
+				target->client.reset();
+				std::strcpy(target->host, host);
+				std::strcpy(target->port, port);
+				target->family = family;
+				_miss_count++;
+			}
+
+			// The slot is reserved while the new connection is being established outside the lock.
+			// Until then, nothing but this thread may touch the slot's client.
+			if (target != nullptr) {
+				target->is_lent = true;
+				target->lent_client = is_hit ? &*target->client : nullptr;
+			}
+		}
+
+		if (target == nullptr) {
+			if (_log != nullptr) {
+				_log->put_any(category::abc::pool, severity::abc::optional, 0x103d3, "connection_pool::acquire() <<< exhausted");
+			}
+
+			return nullptr;
+		}
+
+		if (!is_hit) {
+			try {
+				target->client.emplace(family, _log);
+				target->client->connect(host, port);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				target->client.reset();
+				target->is_lent = false;
+
+				throw;
+			}
+
+			std::lock_guard<std::mutex> lock(_mutex);
+			target->lent_client = &*target->client;
+		}
+
+		if (_log != nullptr) {
+			_log->put_any(category::abc::pool, severity::abc::optional, 0x103d4, "connection_pool::acquire() <<< %s", is_hit ? "hit" : "miss");
+		}
+
+		return &*target->client;
+	}
+
+
+	template <typename Log, std::size_t Size>
+	inline void connection_pool<Log, Size>::release(tcp_client_socket<Log>* client, bool is_healthy) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::pool, severity::abc::debug, 0x103d5, "connection_pool::release() is_healthy=%d", is_healthy);
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		for (slot& s : _slots) {
+			if (s.is_lent && s.lent_client == client) {
+				if (is_healthy && client->is_open()) {
+					s.idle_since = socket::clock::now();
+				}
+				else {
+					s.client.reset();
+				}
+
+				s.is_lent = false;
+				s.lent_client = nullptr;
+				return;
+			}
+		}
+
+		throw exception<std::logic_error, Log>("socket", 0x103d6, _log);
+	}
+
+
+	template <typename Log, std::size_t Size>
+	inline std::size_t connection_pool<Log, Size>::hit_count() const noexcept {
+		return _hit_count;
+	}
+
+
+	template <typename Log, std::size_t Size>
+	inline std::size_t connection_pool<Log, Size>::miss_count() const noexcept {
+		return _miss_count;
+	}
+
+
+	template <typename Log, std::size_t Size>
+	inline bool connection_pool<Log, Size>::is_match(const slot& s, const char* host, const char* port, socket::family_t family) const noexcept {
+		return s.family == family && std::strcmp(s.host, host) == 0 && std::strcmp(s.port, port) == 0;
+	}
+
+
+	template <typename Log, std::size_t Size>
+	inline bool connection_pool<Log, Size>::is_alive(const slot& s) const noexcept {
+		// An idle connection must have nothing to read. If it is readable, the peer has either closed it or sent something unexpected.
+		pollfd handle_poll = { s.client->handle(), POLLIN, 0 };
+
+		return ::poll(&handle_poll, 1, 0) == 0;
+	}
+
+}
@@ -0,0 +1,91 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <optional>
+
+#include "size.h"
+#include "socket.i.h"
+#include "log.i.h"
+
+
+namespace abc {
+
+	// Keeps up to Size connected TCP client sockets keyed by host:port.
+	// A socket is lent out by acquire(), and it must be handed back by release().
+	template <typename Log = null_log, std::size_t Size = size::_16>
+	class connection_pool {
+	public:
+		connection_pool(std::size_t max_per_host = Size, std::chrono::milliseconds max_idle = std::chrono::seconds(60), Log* log = nullptr);
+		connection_pool(Log* log);
+		connection_pool(connection_pool&& other) = delete;
+		connection_pool(const connection_pool& other) = delete;
+
+	public:
+		// Returns an idle connection to host:port if there is one that is still healthy, or a new connection otherwise.
+		// Returns nullptr if max_per_host connections to host:port, or Size connections in total, are already lent out.
+		// Connections of different families to the same host:port are kept apart.
+		tcp_client_socket<Log>*	acquire(const char* host, const char* port, socket::family_t family = socket::family::ipv4);
+
+		// A connection that is not healthy, e.g. the protocol exchange on it failed, is closed rather than kept.
+		void					release(tcp_client_socket<Log>* client, bool is_healthy = true);
+
+		std::size_t				hit_count() const noexcept;
+		std::size_t				miss_count() const noexcept;
+
+	private:
+		struct slot {
+			char								host[size::_256];
+			char								port[size::_16];
+			socket::family_t					family;
+			std::optional<tcp_client_socket<Log>>	client;
+			bool								is_lent;
+
+			// Set once a lent connection is established. The client itself may still be connecting outside the lock.
+			tcp_client_socket<Log>*				lent_client;
+			socket::clock::time_point			idle_since;
+		};
+
+		bool					is_match(const slot& s, const char* host, const char* port, socket::family_t family) const noexcept;
+		bool					is_alive(const slot& s) const noexcept;
+
+	private:
+		const std::size_t			_max_per_host;
+		const std::chrono::milliseconds	_max_idle;
+		Log*						_log;
+
+		std::mutex					_mutex;
+		slot						_slots[Size];
+		std::atomic_size_t			_hit_count;
+		std::atomic_size_t			_miss_count;
+	};
+
+}
@@ -0,0 +1,404 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstring>
+#include <exception>
+
+#include "coroutine.i.h"
+#include "socket.h"
+#include "reactor.h"
+
+
+namespace abc {
+
+	template <std::size_t BlockSize, std::size_t BlockCount>
+	inline frame_pool<BlockSize, BlockCount>::frame_pool() noexcept
+		: _free_count(BlockCount) {
+		for (std::size_t i = 0; i < BlockCount; i++) {
+			_free[i] = i;
+		}
+	}
+
+
+	template <std::size_t BlockSize, std::size_t BlockCount>
+	inline void* frame_pool<BlockSize, BlockCount>::allocate(std::size_t size) noexcept {
+		if (size > BlockSize) {
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (_free_count == 0) {
+			return nullptr;
+		}
+
+		return _blocks[_free[--_free_count]];
+	}
+
+
+	template <std::size_t BlockSize, std::size_t BlockCount>
+	inline void frame_pool<BlockSize, BlockCount>::deallocate(void* ptr) noexcept {
+		std::size_t index = (static_cast<char*>(ptr) - &_blocks[0][0]) / BlockSize;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_free[_free_count++] = index;
+	}
+
+
+	template <std::size_t BlockSize, std::size_t BlockCount>
+	inline std::size_t frame_pool<BlockSize, BlockCount>::free_count() const noexcept {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _free_count;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Arg>
+	inline frame_allocator* _as_frame_allocator(Arg& arg) noexcept {
+		if constexpr (std::is_base_of_v<frame_allocator, Arg>) {
+			return &arg;
+		}
+		else {
+			return nullptr;
+		}
+	}
+
+
+	// Each frame is preceded by a pointer to the allocator it came from.
+	constexpr std::size_t _frame_header_size = alignof(std::max_align_t);
+
+
+	template <typename... Args>
+	inline void* task::promise_type::operator new(std::size_t size, Args&... args) noexcept {
+		static_assert((std::is_base_of_v<frame_allocator, Args> || ...), "A coroutine that returns abc::task must take a frame_allocator& parameter.");
+
+		frame_allocator* allocator = nullptr;
+		((allocator = allocator != nullptr ? allocator : _as_frame_allocator(args)), ...);
+
+		char* ptr = static_cast<char*>(allocator->allocate(_frame_header_size + size));
+		if (ptr == nullptr) {
+			return nullptr;
+		}
+
+		std::memcpy(ptr, &allocator, sizeof(allocator));
+		return ptr + _frame_header_size;
+	}
+
+
+	inline void task::promise_type::operator delete(void* ptr) noexcept {
+		char* header = static_cast<char*>(ptr) - _frame_header_size;
+
+		frame_allocator* allocator;
+		std::memcpy(&allocator, header, sizeof(allocator));
+		allocator->deallocate(header);
+	}
+
+
+	inline task task::promise_type::get_return_object_on_allocation_failure() noexcept {
+		return task(nullptr);
+	}
+
+
+	inline task task::promise_type::get_return_object() noexcept {
+		return task(std::coroutine_handle<promise_type>::from_promise(*this));
+	}
+
+
+	inline std::suspend_never task::promise_type::initial_suspend() noexcept {
+		return { };
+	}
+
+
+	inline task::final_awaiter task::promise_type::final_suspend() noexcept {
+		return { };
+	}
+
+
+	inline void task::promise_type::return_void() noexcept {
+	}
+
+
+	inline void task::promise_type::unhandled_exception() noexcept {
+		// Keep it for the task to report.
+		error = std::current_exception();
+	}
+
+
+	inline bool task::final_awaiter::await_ready() const noexcept {
+		return false;
+	}
+
+
+	inline void task::final_awaiter::await_suspend(std::coroutine_handle<promise_type> coroutine) const noexcept {
+		// If the task has already been destroyed, nobody else will free the frame.
+		if (!coroutine.promise().is_shared.exchange(false)) {
+			coroutine.destroy();
+		}
+	}
+
+
+	inline void task::final_awaiter::await_resume() const noexcept {
+	}
+
+
+	inline task::task(std::coroutine_handle<promise_type> coroutine) noexcept
+		: _coroutine(coroutine) {
+	}
+
+
+	inline task::task(task&& other) noexcept
+		: _coroutine(other._coroutine) {
+		other._coroutine = nullptr;
+	}
+
+
+	inline task::~task() noexcept {
+		// If the coroutine has already finished, nobody else will free the frame.
+		if (_coroutine && !_coroutine.promise().is_shared.exchange(false)) {
+			_coroutine.destroy();
+		}
+	}
+
+
+	inline bool task::is_started() const noexcept {
+		return static_cast<bool>(_coroutine);
+	}
+
+
+	inline bool task::is_done() const noexcept {
+		return _coroutine && _coroutine.done();
+	}
+
+
+	inline std::exception_ptr task::error() const noexcept {
+		return is_done() ? _coroutine.promise().error : nullptr;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Reactor>
+	inline _socket_awaitable<Reactor>::_socket_awaitable(Reactor* reactor, socket::handle_t handle, event_t events) noexcept
+		: _reactor(reactor)
+		, _handle(handle)
+		, _events(events) {
+	}
+
+
+	template <typename Reactor>
+	inline bool _socket_awaitable<Reactor>::await_ready() {
+		return try_complete();
+	}
+
+
+	template <typename Reactor>
+	inline void _socket_awaitable<Reactor>::await_suspend(std::coroutine_handle<> coroutine) {
+		_coroutine = coroutine;
+
+		// If the handle became ready in the meantime, the reactor reports it right away.
+		_reactor->add(_handle, _events | event::oneshot, this);
+	}
+
+
+	template <typename Reactor>
+	inline void _socket_awaitable<Reactor>::on_event(event_t /*events*/) {
+		if (!try_complete()) {
+			// A spurious wakeup. Wait again.
+			_reactor->modify(_handle, _events | event::oneshot, this);
+			return;
+		}
+
+		_reactor->remove(_handle);
+
+		// This awaitable may be destroyed by the time resume() returns.
+		_coroutine.resume();
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Reactor, typename Log>
+	inline receive_awaitable<Reactor, Log>::receive_awaitable(Reactor* reactor, tcp_client_socket<Log>& socket, void* buffer, std::size_t size) noexcept
+		: base(reactor, socket.handle(), event::readable)
+		, _socket(socket)
+		, _buffer(buffer)
+		, _size(size)
+		, _received_size(0) {
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline std::size_t receive_awaitable<Reactor, Log>::await_resume() const noexcept {
+		return _received_size;
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline bool receive_awaitable<Reactor, Log>::try_complete() {
+		return _socket.try_receive(_buffer, _size, _received_size) != socket::status::would_block;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Reactor, typename Log>
+	inline send_awaitable<Reactor, Log>::send_awaitable(Reactor* reactor, tcp_client_socket<Log>& socket, const void* buffer, std::size_t size) noexcept
+		: base(reactor, socket.handle(), event::writable)
+		, _socket(socket)
+		, _buffer(static_cast<const char*>(buffer))
+		, _size(size)
+		, _sent_size(0)
+		, _status(socket::status::done) {
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline socket::status_t send_awaitable<Reactor, Log>::await_resume() const noexcept {
+		return _status;
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline bool send_awaitable<Reactor, Log>::try_complete() {
+		std::size_t sent_size;
+		_status = _socket.try_send(_buffer + _sent_size, _size - _sent_size, sent_size);
+		_sent_size += sent_size;
+
+		return _status != socket::status::would_block;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Reactor, typename Log>
+	inline accept_awaitable<Reactor, Log>::accept_awaitable(Reactor* reactor, tcp_server_socket<Log>& listener) noexcept
+		: base(reactor, listener.handle(), event::readable)
+		, _listener(listener) {
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline tcp_client_socket<Log> accept_awaitable<Reactor, Log>::await_resume() noexcept {
+		return std::move(*_client);
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline bool accept_awaitable<Reactor, Log>::try_complete() {
+		_client.emplace(_listener.accept());
+
+		return _client->is_open();
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Reactor, typename Log>
+	inline request_head_awaitable<Reactor, Log>::request_head_awaitable(Reactor* reactor, tcp_client_socket<Log>& socket, char* buffer, std::size_t size) noexcept
+		: base(reactor, socket.handle(), event::readable)
+		, _socket(socket)
+		, _buffer(buffer)
+		, _size(size)
+		, _head { 0, 0 } {
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline request_head request_head_awaitable<Reactor, Log>::await_resume() const noexcept {
+		return _head;
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline bool request_head_awaitable<Reactor, Log>::try_complete() {
+		constexpr const char end_of_head[] = "\r\n\r\n";
+		constexpr std::size_t end_of_head_size = sizeof(end_of_head) - 1;
+
+		while (_head.received_size < _size) {
+			std::size_t received_size;
+			socket::status_t status = _socket.try_receive(_buffer + _head.received_size, _size - _head.received_size, received_size);
+
+			if (status == socket::status::would_block) {
+				return false;
+			}
+			else if (status != socket::status::done || received_size == 0) {
+				// The peer closed the connection before sending a complete head.
+				return true;
+			}
+
+			// The end of the head may straddle the previous receive.
+			std::size_t search_pos = _head.received_size >= end_of_head_size ? _head.received_size - (end_of_head_size - 1) : 0;
+			_head.received_size += received_size;
+
+			for (std::size_t i = search_pos; i + end_of_head_size <= _head.received_size; i++) {
+				if (std::memcmp(_buffer + i, end_of_head, end_of_head_size) == 0) {
+					_head.head_size = i + end_of_head_size;
+					return true;
+				}
+			}
+		}
+
+		// The head didn't fit.
+		return true;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Reactor, typename Log>
+	inline receive_awaitable<Reactor, Log> async_receive(Reactor& reactor, tcp_client_socket<Log>& socket, void* buffer, std::size_t size) noexcept {
+		return receive_awaitable<Reactor, Log>(&reactor, socket, buffer, size);
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline send_awaitable<Reactor, Log> async_send(Reactor& reactor, tcp_client_socket<Log>& socket, const void* buffer, std::size_t size) noexcept {
+		return send_awaitable<Reactor, Log>(&reactor, socket, buffer, size);
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline accept_awaitable<Reactor, Log> async_accept(Reactor& reactor, tcp_server_socket<Log>& listener) noexcept {
+		return accept_awaitable<Reactor, Log>(&reactor, listener);
+	}
+
+
+	template <typename Reactor, typename Log>
+	inline request_head_awaitable<Reactor, Log> async_receive_request_head(Reactor& reactor, tcp_client_socket<Log>& socket, char* buffer, std::size_t size) noexcept {
+		return request_head_awaitable<Reactor, Log>(&reactor, socket, buffer, size);
+	}
+
+}
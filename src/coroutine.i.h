@@ -0,0 +1,297 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "coroutine.h requires C++20 coroutines (e.g. --std=c++20)."
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <coroutine>
+#include <type_traits>
+#include <optional>
+
+#include "size.h"
+#include "socket.i.h"
+#include "reactor.i.h"
+#include "log.i.h"
+
+
+namespace abc {
+
+	// Coroutine frames are allocated from a frame_allocator that is passed to the coroutine as an argument.
+	class frame_allocator {
+	public:
+		virtual ~frame_allocator() noexcept = default;
+
+		// Returns nullptr if there is no room.
+		virtual void*	allocate(std::size_t size) noexcept = 0;
+		virtual void	deallocate(void* ptr) noexcept = 0;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	// A fixed number of fixed-size blocks.
+	template <std::size_t BlockSize = size::k1, std::size_t BlockCount = size::_64>
+	class frame_pool : public frame_allocator {
+		static_assert(BlockSize % alignof(std::max_align_t) == 0, "BlockSize must be a multiple of alignof(std::max_align_t).");
+		static_assert(BlockCount > 0, "BlockCount must be positive.");
+
+	public:
+		frame_pool() noexcept;
+		frame_pool(frame_pool&& other) = delete;
+		frame_pool(const frame_pool& other) = delete;
+
+	public:
+		virtual void*	allocate(std::size_t size) noexcept override;
+		virtual void	deallocate(void* ptr) noexcept override;
+
+		std::size_t		free_count() const noexcept;
+
+	private:
+		alignas(std::max_align_t) char	_blocks[BlockCount][BlockSize];
+		std::size_t						_free[BlockCount];
+		std::size_t						_free_count;
+		mutable std::mutex				_mutex;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	// The return type of a coroutine that starts right away.
+	// One of the coroutine's parameters must be a frame_allocator. If it has no room for the frame, the coroutine doesn't start.
+	// The frame is freed once the coroutine has finished and the task has been destroyed, whichever happens last.
+	class task {
+	public:
+		struct final_awaiter;
+
+		struct promise_type {
+			template <typename... Args>
+			static void*	operator new(std::size_t size, Args&... args) noexcept;
+			static void		operator delete(void* ptr) noexcept;
+
+			static task		get_return_object_on_allocation_failure() noexcept;
+			task			get_return_object() noexcept;
+
+			std::suspend_never	initial_suspend() noexcept;
+			final_awaiter		final_suspend() noexcept;
+			void				return_void() noexcept;
+			void				unhandled_exception() noexcept;
+
+			// The exception that escaped the coroutine, if any.
+			std::exception_ptr	error;
+
+			// Both the coroutine and the task hold the frame. The one that lets go of it second frees it.
+			std::atomic_bool	is_shared { true };
+		};
+
+		struct final_awaiter {
+			bool	await_ready() const noexcept;
+			void	await_suspend(std::coroutine_handle<promise_type> coroutine) const noexcept;
+			void	await_resume() const noexcept;
+		};
+
+	public:
+		task(task&& other) noexcept;
+		task(const task& other) = delete;
+		~task() noexcept;
+
+	public:
+		// false if the frame could not be allocated.
+		bool				is_started() const noexcept;
+
+		// Must be called on the thread that resumes the coroutine, e.g. the one that runs the reactor.
+		bool				is_done() const noexcept;
+
+		// The exception that escaped the coroutine once it is done, or nullptr.
+		// If the task is destroyed before the coroutine is done, such an exception is lost.
+		std::exception_ptr	error() const noexcept;
+
+	private:
+		task(std::coroutine_handle<promise_type> coroutine) noexcept;
+
+	private:
+		std::coroutine_handle<promise_type>	_coroutine;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	// An awaitable that completes an I/O operation on a socket.
+	// If the operation can't complete right away, the socket handle is registered with the reactor, and the coroutine is resumed
+	// on the thread that runs the reactor once the operation completes.
+	template <typename Reactor>
+	class _socket_awaitable : public reactor_handler {
+	protected:
+		_socket_awaitable(Reactor* reactor, socket::handle_t handle, event_t events) noexcept;
+		_socket_awaitable(const _socket_awaitable& other) = delete;
+
+	public:
+		bool			await_ready();
+		void			await_suspend(std::coroutine_handle<> coroutine);
+
+		virtual void	on_event(event_t events) override;
+
+	protected:
+		// Returns false if the operation would block.
+		virtual bool	try_complete() = 0;
+
+	private:
+		Reactor*				_reactor;
+		socket::handle_t		_handle;
+		event_t					_events;
+		std::coroutine_handle<>	_coroutine;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	// Receives whatever is available. Resumes with the number of bytes received, which is 0 if the peer has closed the connection.
+	template <typename Reactor, typename Log = null_log>
+	class receive_awaitable : public _socket_awaitable<Reactor> {
+		using base = _socket_awaitable<Reactor>;
+
+	public:
+		receive_awaitable(Reactor* reactor, tcp_client_socket<Log>& socket, void* buffer, std::size_t size) noexcept;
+
+	public:
+		std::size_t		await_resume() const noexcept;
+
+	protected:
+		virtual bool	try_complete() override;
+
+	private:
+		tcp_client_socket<Log>&	_socket;
+		void*					_buffer;
+		std::size_t				_size;
+		std::size_t				_received_size;
+	};
+
+
+	// Sends all the bytes. Resumes with socket::status::done, or with socket::status::closed if the peer has closed the connection.
+	template <typename Reactor, typename Log = null_log>
+	class send_awaitable : public _socket_awaitable<Reactor> {
+		using base = _socket_awaitable<Reactor>;
+
+	public:
+		send_awaitable(Reactor* reactor, tcp_client_socket<Log>& socket, const void* buffer, std::size_t size) noexcept;
+
+	public:
+		socket::status_t	await_resume() const noexcept;
+
+	protected:
+		virtual bool		try_complete() override;
+
+	private:
+		tcp_client_socket<Log>&	_socket;
+		const char*				_buffer;
+		std::size_t				_size;
+		std::size_t				_sent_size;
+		socket::status_t		_status;
+	};
+
+
+	// Accepts a connection. The listener must be non-blocking. Resumes with the accepted socket.
+	template <typename Reactor, typename Log = null_log>
+	class accept_awaitable : public _socket_awaitable<Reactor> {
+		using base = _socket_awaitable<Reactor>;
+
+	public:
+		accept_awaitable(Reactor* reactor, tcp_server_socket<Log>& listener) noexcept;
+
+	public:
+		tcp_client_socket<Log>	await_resume() noexcept;
+
+	protected:
+		virtual bool			try_complete() override;
+
+	private:
+		tcp_server_socket<Log>&					_listener;
+		std::optional<tcp_client_socket<Log>>	_client;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	struct request_head {
+		// The size of the request line and the headers, including the empty line. 0 if the connection was closed or the head didn't fit.
+		std::size_t		head_size;
+
+		// The number of bytes received, which may include the beginning of the body.
+		std::size_t		received_size;
+	};
+
+
+	// Receives until the buffer contains a complete HTTP request head, so that an http_request_istream over a buffer_streambuf
+	// can then read the head without blocking.
+	template <typename Reactor, typename Log = null_log>
+	class request_head_awaitable : public _socket_awaitable<Reactor> {
+		using base = _socket_awaitable<Reactor>;
+
+	public:
+		request_head_awaitable(Reactor* reactor, tcp_client_socket<Log>& socket, char* buffer, std::size_t size) noexcept;
+
+	public:
+		request_head		await_resume() const noexcept;
+
+	protected:
+		virtual bool		try_complete() override;
+
+	private:
+		tcp_client_socket<Log>&	_socket;
+		char*					_buffer;
+		std::size_t				_size;
+		request_head			_head;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Reactor, typename Log>
+	receive_awaitable<Reactor, Log>			async_receive(Reactor& reactor, tcp_client_socket<Log>& socket, void* buffer, std::size_t size) noexcept;
+
+	template <typename Reactor, typename Log>
+	send_awaitable<Reactor, Log>			async_send(Reactor& reactor, tcp_client_socket<Log>& socket, const void* buffer, std::size_t size) noexcept;
+
+	template <typename Reactor, typename Log>
+	accept_awaitable<Reactor, Log>			async_accept(Reactor& reactor, tcp_server_socket<Log>& listener) noexcept;
+
+	template <typename Reactor, typename Log>
+	request_head_awaitable<Reactor, Log>	async_receive_request_head(Reactor& reactor, tcp_client_socket<Log>& socket, char* buffer, std::size_t size) noexcept;
+
+}
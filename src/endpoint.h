@@ -24,20 +24,29 @@ SOFTWARE.
 
 
 #include <iostream>
+#include <algorithm>
 #include <fstream>
 #include <filesystem>
 #include <system_error>
 #include <future>
+#include <chrono>
 #include <thread>
 #include <atomic>
 #include <exception>
 #include <cstring>
+#include <cerrno>
+#include <limits>
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
 
 #include "endpoint.i.h"
 #include "exception.h"
 #include "log.h"
 #include "socket.h"
 #include "http.h"
+#include "queue.h"
+#include "timer_wheel.h"
 
 
 namespace abc {
@@ -47,7 +56,8 @@ namespace abc {
 		: _config(config)
 		, _log(log)
 		, _requests_in_progress(0)
-		, _is_shutdown_requested(false) {
+		, _is_shutdown_requested(false)
+		, _timers(std::chrono::milliseconds(Limits::timer_tick_ms), log) {
 	}
 
 
@@ -67,16 +77,75 @@ namespace abc {
 			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102f1, "Started endpoint (%s)", _config->port);
 		}
 
+		// Stale connections are closed from the timer thread.
+		if (_config->idle_timeout_ms > 0) {
+			std::thread(&timer_wheel<Limits::timer_count, Log>::run, &_timers).detach();
+		}
+
+		for (std::size_t worker_index = 0; worker_index < _config->worker_count; worker_index++) {
+			std::thread(&endpoint<Limits, Log>::worker_loop, this).detach();
+		}
+
+		// Each additional listener gets its own thread. The first one runs on this thread.
+		for (std::size_t listener_index = 1; listener_index < listener_count(); listener_index++) {
+			std::thread(&endpoint<Limits, Log>::accept_loop, this, listener_index).detach();
+		}
+
+		accept_loop(0);
+	}
+
+
+	template <typename Limits, typename Log>
+	inline const socket_stats& endpoint<Limits, Log>::stats() const noexcept {
+		return _stats;
+	}
+
+
+	template <typename Limits, typename Log>
+	inline std::size_t endpoint<Limits, Log>::listener_count() const noexcept {
+		return _config->family == socket::family::local ? 1 : _config->listener_count;
+	}
+
+
+	template <typename Limits, typename Log>
+	inline void endpoint<Limits, Log>::accept_loop(std::size_t listener_index) {
 		// Create a listener, bind to a port, and start listening.
-		abc::tcp_server_socket listener(_log);
+		abc::tcp_server_socket listener(_config->family, _log);
+
+		if (listener_count() > 1) {
+			listener.set_reuse_port(true);
+
+			// Pin the accepting thread to a core, so that the connections the kernel assigns to this listener stay on that core.
+			unsigned int core_count = std::thread::hardware_concurrency();
+			if (core_count > 0) {
+				cpu_set_t cpu_set;
+				CPU_ZERO(&cpu_set);
+				CPU_SET(listener_index % core_count, &cpu_set);
+
+				if (::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set) != 0 && _log != nullptr) {
+					_log->put_any(abc::category::abc::endpoint, abc::severity::warning, 0x103bb, "Could not pin listener %zu to a core", listener_index);
+				}
+			}
+		}
+
+		// A socket file left behind by a previous run would fail the bind.
+		if (_config->family == socket::family::local && _config->port[0] != '@') {
+			::unlink(_config->port);
+		}
+
 		listener.bind(_config->port);
 		listener.listen(_config->listen_queue_size);
 
 		if (_log != nullptr) {
-			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102f2, "Listening (%s)", _config->port);
+			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102f2, "Listening (%s) listener=%zu", _config->port, listener_index);
 			_log->put_blank_line();
 		}
 
+		if (_config->worker_count > 0) {
+			accept_batches(listener);
+			return;
+		}
+
 		while (true) {
 			// Accept the next request and process it asynchronously.
 			abc::tcp_client_socket client = listener.accept();
@@ -85,72 +154,403 @@ namespace abc {
 	}
 
 
+	template <typename Limits, typename Log>
+	inline void endpoint<Limits, Log>::accept_batches(tcp_server_socket<Log>& listener) {
+		// Wait for connections with poll(), and drain the whole backlog on each wakeup.
+		listener.set_blocking(false);
+
+		pollfd listener_fd { };
+		listener_fd.fd = listener.handle();
+		listener_fd.events = POLLIN;
+
+		socket::handle_t handles[Limits::accept_batch_size];
+
+		while (true) {
+			if (::poll(&listener_fd, 1, -1) < 0) {
+				if (errno != EINTR) {
+					// Something is wrong beyond an interrupted wait. Back off instead of spinning on it.
+					if (_log != nullptr) {
+						_log->put_any(abc::category::abc::endpoint, abc::severity::warning, 0x104c3, "poll() failed (%s) errno=%d", _config->port, errno);
+					}
+
+					std::this_thread::sleep_for(std::chrono::milliseconds(Limits::accept_backoff_ms));
+				}
+
+				continue;
+			}
+
+			std::size_t count;
+			try {
+				// The workers use blocking streams, so the accepted sockets are blocking.
+				count = listener.accept_all(handles, Limits::accept_batch_size, true);
+			}
+			catch (const std::exception&) {
+				// The exception has already been logged. Keep accepting.
+				continue;
+			}
+
+			for (std::size_t i = 0; i < count; i++) {
+				if (!_accept_queue.try_push(handles[i])) {
+					// The workers are behind. Don't let the connection wait.
+					if (_log != nullptr) {
+						_log->put_any(abc::category::abc::endpoint, abc::severity::abc::optional, 0x103ee, "Accept queue is full (%s)", _config->port);
+					}
+
+					std::thread(&endpoint<Limits, Log>::process_request, this, tcp_client_socket<Log>(handles[i], _config->family, _log)).detach();
+				}
+			}
+
+			_accept_queue.notify();
+		}
+	}
+
+
+	template <typename Limits, typename Log>
+	inline void endpoint<Limits, Log>::worker_loop() {
+		while (true) {
+			socket::handle_t handle;
+			_accept_queue.pop(handle);
+
+			process_request(tcp_client_socket<Log>(handle, _config->family, _log));
+		}
+	}
+
+
 	template <typename Limits, typename Log>
 	inline void endpoint<Limits, Log>::process_request(tcp_client_socket<Log>&& socket) {
 		if (_log != nullptr) {
-			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102de, "Begin handling request (%s)", _config->port);
+			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102de, "Begin handling connection (%s)", _config->port);
+		}
+
+		socket.set_stats(&_stats);
+
+		// Don't let an idle client hold this thread forever.
+		// The socket timeout catches a client that stops sending. The timer catches a client that sends the request line too slowly.
+		stale_connection_closer closer(socket.handle());
+
+		if (_config->idle_timeout_ms > 0) {
+			socket.set_idle_timeout(std::chrono::milliseconds(_config->idle_timeout_ms));
 		}
 
 		// Create a socket_streambuf over the tcp_client_socket.
-		abc::socket_streambuf sb(&socket);
+		client_streambuf sb(&socket);
+
+		// The many small flushes of a response are sent in as few segments as possible.
+		// Flushes outside of a response, e.g. of an error response, are sent right away.
+		sb.set_coalescing(Limits::coalescing_size);
 
 		// Create an hhtp_server_stream, which combines http_request_istream and http_response_ostream.
 		abc::http_server_stream<Log> http(&sb);
 
-		// Read the request line.
-		char method[Limits::method_size + 1];
-		http.get_method(method, sizeof(method));
-		if (_log != nullptr) {
-			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102df, "Received Method   = '%s'", method);
+		// Requests are processed one at a time in the order they were received, including pipelined ones.
+		for (std::size_t request_count = 1; ; request_count++) {
+			timer_id_t timer = timer_id::invalid;
+			if (_config->idle_timeout_ms > 0) {
+				timer = _timers.schedule(std::chrono::milliseconds(_config->idle_timeout_ms), &closer);
+
+				// The socket timeout still catches a client that stops sending, but not one that sends the request line too slowly.
+				if (timer == timer_id::invalid && _log != nullptr) {
+					_log->put_any(abc::category::abc::endpoint, abc::severity::warning, 0x104c5, "Timer wheel is full (%s). Falling back to the socket timeout.", _config->port);
+				}
+			}
+
+			// Find out where this request ends before any of it is consumed.
+			std::size_t request_end = sb.consumed_size();
+			std::size_t request_size = 0;
+			bool is_bad_request = false;
+			http.set_keep_alive(peek_request(sb, request_count, request_size, is_bad_request));
+			request_end += request_size;
+
+			// There is no telling where the body of a bad request ends, so the connection is closed after the error response.
+			if (is_bad_request) {
+				_timers.cancel(timer);
+
+				try {
+					sb.begin_response();
+					send_simple_response(http, status_code::Bad_Request, reason_phrase::Bad_Request, content_type::text, "Error: Malformed request head.", 0x104d4);
+					http.flush();
+					sb.end_response();
+				}
+				catch (const std::exception&) {
+					// The exception has already been logged. The connection is dropped either way.
+				}
+
+				break;
+			}
+
+			// Read the request line.
+			char method[Limits::method_size + 1];
+			http.get_method(method, sizeof(method));
+			if (_log != nullptr) {
+				_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102df, "Received Method   = '%s'", method);
+			}
+
+			char path[Limits::resource_size + 1];
+			std::strcpy(path, _config->root_dir);
+			char* resource = path + _config->root_dir_len;
+			http.get_resource(resource, sizeof(path) - _config->root_dir_len);
+			if (_log != nullptr) {
+				_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102e0, "Received Resource = '%s'", resource);
+			}
+
+			char protocol[Limits::protocol_size + 1];
+			http.get_protocol(protocol, sizeof(protocol));
+			if (_log != nullptr) {
+				_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102e1, "Received Protocol = '%s'", protocol);
+			}
+
+			// The closer must not fire once the request line has been received. If it is firing right now, this waits for it.
+			_timers.cancel(timer);
+
+			// If the client closed the connection or went idle, there is no one to respond to.
+			const abc::http_request_istream<Log>& http_in = http;
+			if (http_in.bad() || http_in.eof()) {
+				if (_log != nullptr) {
+					_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x103c7, "Dropped connection (%s)", _config->port);
+					_log->put_blank_line();
+				}
+
+				return;
+			}
+
+			// It's OK to read a request as long as we don't return a broken response.
+			if (_is_shutdown_requested.load()) {
+				return;
+			}
+
+			++_requests_in_progress;
+
+			bool is_sent = false;
+			try {
+				// The many small flushes of the response are held back until end_response().
+				sb.begin_response();
+
+				// This endpoint supports two kinds of requests:
+				//    a) requests for static files
+				//    b) REST requests
+				if (is_file_request(method, resource)) {
+					process_file_request(http, method, resource, path);
+				}
+				else {
+					process_rest_request(http, method, resource);
+				}
+
+				// Don't forget to flush!
+				http.flush();
+				sb.end_response();
+
+				// An invalid item makes the stream skip the rest of the response. What the client got can't be framed, so the connection is closed.
+				const abc::http_response_ostream<Log>& http_out = http;
+				is_sent = !http_out.bad();
+
+				if (_log != nullptr) {
+					if (is_sent) {
+						_log->put_any(abc::category::abc::endpoint, abc::severity::abc::optional, 0x102e2, "Response sent");
+						_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102e3, "End handling request (%s) request_count=%zu, keep_alive=%d", _config->port, request_count, http.keep_alive());
+					}
+					else {
+						_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x104d7, "Broken response (%s). Closing the connection.", _config->port);
+					}
+				}
+			}
+			catch (const std::exception&) {
+				// The exception has already been logged. The connection is dropped.
+				if (_log != nullptr) {
+					_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x103c8, "Dropped connection (%s)", _config->port);
+					_log->put_blank_line();
+				}
+			}
+
+			if (--_requests_in_progress == 0 && _is_shutdown_requested.load()) {
+				if (_log != nullptr) {
+					_log->put_blank_line();
+					_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102f3, "Stopped endpoint (%s)", _config->port);
+				}
+
+				_promise.set_value();
+			}
+
+			// The next request starts right after this one - whatever the handler has left unread is skipped.
+			if (!is_sent || !http.keep_alive() || _is_shutdown_requested.load() || !skip_request(sb, request_end)) {
+				break;
+			}
+
+			// Without an idle timeout, a client that keeps the connection open but never sends another request would hold this thread forever.
+			if (request_count == 1 && _config->idle_timeout_ms == 0) {
+				socket.set_idle_timeout(std::chrono::milliseconds(Limits::keep_alive_timeout_ms));
+			}
+
+			http.reset();
 		}
 
-		char path[Limits::resource_size + 1];
-		std::strcpy(path, _config->root_dir);
-		char* resource = path + _config->root_dir_len;
-		http.get_resource(resource, sizeof(path) - _config->root_dir_len);
 		if (_log != nullptr) {
-			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102e0, "Received Resource = '%s'", resource);
+			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x104a0, "End handling connection (%s)", _config->port);
+			_log->put_blank_line();
 		}
+	}
 
-		char protocol[Limits::protocol_size + 1];
-		http.get_protocol(protocol, sizeof(protocol));
-		if (_log != nullptr) {
-			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102e1, "Received Protocol = '%s'", protocol);
+
+	template <typename Limits, typename Log>
+	inline bool endpoint<Limits, Log>::peek_request(client_streambuf& sb, std::size_t request_count, std::size_t& request_size, bool& is_bad_request) {
+		request_size = 0;
+		is_bad_request = false;
+
+		if (request_count >= Limits::max_requests_per_connection || _is_shutdown_requested.load()) {
+			return false;
 		}
 
-		// It's OK to read a request as long as we don't return a broken response.
-		if (_is_shutdown_requested.load()) {
-			return;
+		// Receive until the whole head is buffered. If it doesn't fit in the get area of Limits::request_head_size, the connection is closed after this request.
+		http_request_parser<size::_32, Log> parser(_log);
+		http::parse_status_t status = http::parse_status::need_more;
+		std::size_t buffered_size = 0;
+
+		try {
+			while (status == http::parse_status::need_more) {
+				std::size_t size = sb.fill_get_area(buffered_size + 1);
+				if (size <= buffered_size) {
+					break;
+				}
+
+				buffered_size = size;
+				char_span head = sb.peek_span();
+				status = parser.parse(head.data, head.size);
+			}
+		}
+		catch (const std::exception&) {
+			// The exception has already been logged. Reading the request line will fail the same way.
+			return false;
+		}
+
+		// A head that is not well-formed could be framed differently by a proxy in front of this endpoint, so it is not served at all.
+		if (status == http::parse_status::bad) {
+			if (_log != nullptr) {
+				_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x104de, "Bad request head (%s) buffered_size=%zu", _config->port, buffered_size);
+			}
+
+			is_bad_request = true;
+			return false;
 		}
 
-		++_requests_in_progress;
+		if (status != http::parse_status::done) {
+			if (_log != nullptr) {
+				if (buffered_size >= Limits::request_head_size) {
+					_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x104d5, "Request head doesn't fit (%s) request_head_size=%zu. Closing after this request.", _config->port, Limits::request_head_size);
+				}
+				else {
+					_log->put_any(abc::category::abc::endpoint, abc::severity::abc::optional, 0x104d6, "Request head not parsed (%s) status=%u, buffered_size=%zu", _config->port, (unsigned)status, buffered_size);
+				}
+			}
 
-		// This endpoint supports two kinds of requests:
-		//    a) requests for static files
-		//    b) REST requests
-		if (is_file_request(method, resource)) {
-			process_file_request(http, method, resource, path);
+			return false;
 		}
-		else {
-			process_rest_request(http, method, resource);
+
+		// HTTP/1.1 connections are persistent unless the client says otherwise. HTTP/1.0 connections are the opposite.
+		char_span protocol = parser.protocol();
+		bool is_http_10 = protocol.size == std::strlen(protocol::HTTP_10) && ascii::are_equal_i_n(protocol.data, protocol::HTTP_10, protocol.size);
+
+		char_span connection = parser.find_header(header::Connection);
+		bool keep_alive = is_http_10 ? has_connection_option(connection, connection::keep_alive) : !has_connection_option(connection, connection::close);
+
+		// A chunked body doesn't have a known size, so there is no telling where the next request would start.
+		if (parser.find_header(header::Transfer_Encoding).data != nullptr) {
+			keep_alive = false;
+		}
+
+		// A Content-Length that is repeated, isn't a number, or doesn't fit, leaves no telling where the body ends.
+		std::size_t content_length = 0;
+		std::size_t content_length_count = 0;
+		std::size_t content_length_name_size = std::strlen(header::Content_Length);
+		for (std::size_t h = 0; h < parser.header_count(); h++) {
+			http::header hdr = parser.header(h);
+			if (hdr.name.size != content_length_name_size || !ascii::are_equal_i_n(hdr.name.data, header::Content_Length, content_length_name_size)) {
+				continue;
+			}
+
+			bool is_valid = ++content_length_count == 1 && hdr.value.size > 0;
+			for (std::size_t i = 0; is_valid && i < hdr.value.size; i++) {
+				std::size_t digit = hdr.value.data[i] - '0';
+				is_valid = ascii::is_digit(hdr.value.data[i]) && content_length <= (std::numeric_limits<std::size_t>::max() - digit) / 10;
+				content_length = content_length * 10 + digit;
+			}
+
+			if (!is_valid || content_length > std::numeric_limits<std::size_t>::max() - parser.head_size()) {
+				if (_log != nullptr) {
+					_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x104d3, "Invalid Content-Length (%s) count=%zu", _config->port, content_length_count);
+				}
+
+				is_bad_request = true;
+				return false;
+			}
+		}
+
+		if (keep_alive) {
+			request_size = parser.head_size() + content_length;
 		}
 
-		// Don't forget to flush!
-		http.flush();
 		if (_log != nullptr) {
-			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::optional, 0x102e2, "Response sent");
-			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102e3, "End handling request (%s)", _config->port);
-			_log->put_blank_line();
+			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::optional, 0x104a1, "Peeked request head_size=%zu, content_length=%zu, keep_alive=%d", parser.head_size(), content_length, keep_alive);
 		}
 
-		if (--_requests_in_progress == 0 && _is_shutdown_requested.load()) {
+		return keep_alive;
+	}
+
+
+	template <typename Limits, typename Log>
+	inline bool endpoint<Limits, Log>::skip_request(client_streambuf& sb, std::size_t request_end) {
+		std::size_t consumed_size = sb.consumed_size();
+
+		// The handler has read past the end of the request.
+		if (consumed_size > request_end) {
 			if (_log != nullptr) {
-				_log->put_blank_line();
-				_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x102f3, "Stopped endpoint (%s)", _config->port);
+				_log->put_any(abc::category::abc::endpoint, abc::severity::abc::important, 0x104a2, "Request overread consumed_size=%zu, request_end=%zu", consumed_size, request_end);
 			}
 
-			_promise.set_value();
+			return false;
+		}
+
+		try {
+			for (std::size_t skip_size = request_end - consumed_size; skip_size > 0; ) {
+				char_span span = sb.peek_span();
+				if (span.size == 0) {
+					return false;
+				}
+
+				std::size_t size = std::min(span.size, skip_size);
+				sb.consume(size);
+				skip_size -= size;
+			}
 		}
+		catch (const std::exception&) {
+			// The exception has already been logged.
+			return false;
+		}
+
+		return true;
+	}
+
+
+	template <typename Limits, typename Log>
+	inline bool endpoint<Limits, Log>::has_connection_option(char_span connection, const char* option) {
+		// The Connection header is a comma-separated list of options.
+		std::size_t option_size = std::strlen(option);
+		std::size_t pos = 0;
+
+		while (pos < connection.size) {
+			while (pos < connection.size && (ascii::is_space(connection.data[pos]) || connection.data[pos] == ',')) {
+				pos++;
+			}
+
+			std::size_t begin = pos;
+			while (pos < connection.size && !ascii::is_space(connection.data[pos]) && connection.data[pos] != ',') {
+				pos++;
+			}
+
+			if (pos - begin == option_size && ascii::are_equal_i_n(connection.data + begin, option, option_size)) {
+				return true;
+			}
+		}
+
+		return false;
 	}
 
 
@@ -189,12 +589,15 @@ namespace abc {
 			_log->put_any(abc::category::abc::endpoint, abc::severity::abc::optional, 0x102e9, "Sending response 200");
 		}
 
+		// Keep the head in the buffer until the body is sent, so it doesn't go out in pieces.
+		http.set_flush(http::flush::body);
+
 		http.put_protocol(protocol::HTTP_11);
 		http.put_status_code(status_code::OK);
 		http.put_reason_phrase(reason_phrase::OK);
 
 		http.put_header_name(header::Connection);
-		http.put_header_value(connection::close);
+		http.put_header_value(http.keep_alive() ? connection::keep_alive : connection::close);
 
 		const char* content_type = get_content_type_from_path(path);
 		if (content_type != nullptr) {
@@ -206,6 +609,28 @@ namespace abc {
 		http.put_header_value(fsize_buffer);
 		http.end_headers();
 
+		// If the stream is over a socket, send the file straight from the kernel's page cache.
+		client_streambuf* sb = dynamic_cast<client_streambuf*>(static_cast<abc::http_response_ostream<Log>&>(http).rdbuf());
+		int file_handle = sb != nullptr ? ::open(path, O_RDONLY) : -1;
+
+		if (file_handle >= 0) {
+			if (_log != nullptr) {
+				_log->put_any(abc::category::abc::endpoint, abc::severity::abc::optional, 0x103b5, "Sending file with sendfile()");
+			}
+
+			try {
+				sb->send_file(file_handle, 0, fsize);
+			}
+			catch (...) {
+				::close(file_handle);
+				throw;
+			}
+
+			::close(file_handle);
+			return;
+		}
+
+		// Otherwise, copy the file through the stream.
 		std::ifstream file(path);
 		char file_chunk[Limits::file_chunk_size];
 		for (std::uintmax_t sent_size = 0; sent_size < fsize; sent_size += Limits::file_chunk_size) {
@@ -243,7 +668,7 @@ namespace abc {
 		http.put_reason_phrase(reason_phrase);
 
 		http.put_header_name(header::Connection);
-		http.put_header_value(connection::close);
+		http.put_header_value(http.keep_alive() ? connection::keep_alive : connection::close);
 		http.put_header_name(header::Content_Type);
 		http.put_header_value(content_type);
 		http.put_header_name(header::Content_Length);
@@ -326,11 +751,30 @@ namespace abc {
 	// --------------------------------------------------------------
 
 
+	inline stale_connection_closer::stale_connection_closer(socket::handle_t handle) noexcept
+		: _handle(handle) {
+	}
+
+
+	inline void stale_connection_closer::on_timer() {
+		// The handle is closed by its owner, which cancels the timer first.
+		::shutdown(_handle, SHUT_RDWR);
+	}
+
+
+	// --------------------------------------------------------------
+
+
+
 	inline endpoint_config::endpoint_config(const char* port, std::size_t listen_queue_size, const char* root_dir, const char* files_prefix)
 		: port(port)
-
 		, listen_queue_size(listen_queue_size)
 
+		, family(socket::family::ipv4)
+		, listener_count(1)
+		, idle_timeout_ms(0)
+		, worker_count(0)
+
 		, root_dir(root_dir)
 		, root_dir_len(root_dir != nullptr ? std::strlen(root_dir) : 0)
 
@@ -29,17 +29,38 @@ SOFTWARE.
 #include "log.h"
 #include "socket.h"
 #include "http.h"
+#include "queue.h"
+#include "timer_wheel.h"
 
 
 namespace abc {
 
+	// The constructor takes the settings every endpoint needs.
+	// The optional settings below have defaults, and may be changed after construction, as long as that is before the endpoint starts.
 	struct endpoint_config {
 		endpoint_config(const char* port, std::size_t listen_queue_size, const char* root_dir, const char* files_prefix);
 
+		// For socket::family::local, this is the socket path.
 		const char* const	port;
 
 		const std::size_t	listen_queue_size;
 
+		// Optional. The default is socket::family::ipv4.
+		socket::family_t	family;
+
+		// Optional. When greater than 1, that many listeners share the port (SO_REUSEPORT), each accepting on its own thread pinned to a core.
+		// Local endpoints always have a single listener. The default is 1.
+		std::size_t			listener_count;
+
+		// Optional. When greater than 0, a connection is dropped once the client has been idle for that long,
+		// or if it hasn't sent a complete request line in that much time.
+		// When 0, a kept-alive connection is still dropped once the client has been idle for Limits::keep_alive_timeout_ms between requests. The default is 0.
+		std::size_t			idle_timeout_ms;
+
+		// Optional. When greater than 0, the listeners drain their backlogs in batches and hand the connections off to that many worker threads.
+		// When 0, each connection gets its own thread. The default is 0.
+		std::size_t			worker_count;
+
 		const char* const	root_dir; 
 		const std::size_t	root_dir_len; // Computed
 
@@ -55,8 +76,17 @@ namespace abc {
 		static constexpr std::size_t method_size		= abc::size::_32;
 		static constexpr std::size_t resource_size		= abc::size::k2;
 		static constexpr std::size_t protocol_size		= abc::size::_16;
+		static constexpr std::size_t request_head_size	= abc::size::k4;
 		static constexpr std::size_t file_chunk_size	= abc::size::k1;
 		static constexpr std::size_t fsize_size			= abc::size::_32;
+		static constexpr std::size_t accept_queue_size	= abc::size::_256;
+		static constexpr std::size_t accept_batch_size	= abc::size::_64;
+		static constexpr std::size_t accept_backoff_ms	= 100;
+		static constexpr std::size_t timer_count		= abc::size::k1;
+		static constexpr std::size_t timer_tick_ms		= 10;
+		static constexpr std::size_t coalescing_size	= abc::size::k1;
+		static constexpr std::size_t max_requests_per_connection	= 100;
+		static constexpr std::size_t keep_alive_timeout_ms	= 1000;
 	};
 
 
@@ -64,6 +94,7 @@ namespace abc {
 
 
 	namespace protocol {
+		constexpr const char* HTTP_10					= "HTTP/1.0";
 		constexpr const char* HTTP_11					= "HTTP/1.1";
 	}
 
@@ -127,11 +158,18 @@ namespace abc {
 		constexpr const char* Connection				= "Connection";
 		constexpr const char* Content_Type				= "Content-Type";
 		constexpr const char* Content_Length			= "Content-Length";
+		constexpr const char* Transfer_Encoding			= "Transfer-Encoding";
 	}
 
 
 	namespace connection {
 		constexpr const char* close						= "close";
+		constexpr const char* keep_alive				= "keep-alive";
+	}
+
+
+	namespace transfer_encoding {
+		constexpr const char* chunked					= "chunked";
 	}
 
 
@@ -155,8 +193,27 @@ namespace abc {
 	// --------------------------------------------------------------
 
 
+	// Shuts a connection down when its timer fires. Any thread blocked on the socket wakes up with an error.
+	class stale_connection_closer : public timer_handler {
+	public:
+		stale_connection_closer(socket::handle_t handle) noexcept;
+
+	public:
+		virtual void on_timer() override;
+
+	private:
+		socket::handle_t	_handle;
+	};
+
+
+	// --------------------------------------------------------------
+
+
 	template <typename Limits, typename Log>
 	class endpoint {
+	protected:
+		using client_streambuf = socket_streambuf<tcp_client_socket<Log>, Log, Limits::request_head_size>;
+
 	public:
 		endpoint(endpoint_config* config, Log* log);
 
@@ -164,6 +221,9 @@ namespace abc {
 		std::future<void>	start_async();
 		void				start();
 
+		// The I/O counters of all the connections this endpoint has served.
+		const socket_stats&	stats() const noexcept;
+
 	protected:
 		virtual void		process_file_request(abc::http_server_stream<Log>& http, const char* method, const char* resource, const char* path);
 		virtual void		process_rest_request(abc::http_server_stream<Log>& http, const char* method, const char* resource);
@@ -172,9 +232,25 @@ namespace abc {
 		virtual const char*	get_content_type_from_path(const char* path);
 
 	protected:
+		void				accept_loop(std::size_t listener_index);
+		void				accept_batches(tcp_server_socket<Log>& listener);
+		void				worker_loop();
 		void				process_request(tcp_client_socket<Log>&& socket);
 		void				set_shutdown_requested();
 
+		// The number of listeners that actually share the port. Local endpoints always have a single listener.
+		std::size_t			listener_count() const noexcept;
+
+		// Parses the next request head without consuming it, to find out whether the connection may stay open after this request.
+		// If it may, request_size is set to the size of the whole request, head and body.
+		// If the head is malformed, or has a Content-Length that can't be trusted, is_bad_request is set, and the request should be answered with 400.
+		bool				peek_request(client_streambuf& sb, std::size_t request_count, std::size_t& request_size, bool& is_bad_request);
+
+		// Consumes what the handler left unread of the current request. Returns false if the next request can't be found.
+		bool				skip_request(client_streambuf& sb, std::size_t request_end);
+
+		static bool			has_connection_option(char_span connection, const char* option);
+
 	protected:
 		endpoint_config*	_config;
 		Log*				_log;
@@ -183,6 +259,10 @@ namespace abc {
 		std::promise<void>	_promise;
 		std::atomic_int32_t	_requests_in_progress;
 		std::atomic_bool	_is_shutdown_requested;
+
+		mpmc_queue<socket::handle_t, Limits::accept_queue_size>	_accept_queue;
+		socket_stats		_stats;
+		timer_wheel<Limits::timer_count, Log>	_timers;
 	};
 
 
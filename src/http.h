@@ -26,8 +26,10 @@ SOFTWARE.
 #pragma once
 
 #include <cstring>
+#include <algorithm>
 
 #include "ascii.h"
+#include "scan.h"
 #include "exception.h"
 #include "http.i.h"
 #include "stream.h"
@@ -90,7 +92,10 @@ namespace abc {
 	template <typename Log>
 	inline _http_istream<Log>::_http_istream(std::streambuf* sb, http::item_t next, Log* log)
 		: base(sb)
-		, state(next, log) {
+		, state(next, log)
+		, _is_transfer_encoding(false)
+		, _chunk_state(http::chunk_state::none)
+		, _chunk_size(0) {
 		Log* log_local = state::log();
 		if (log_local != nullptr) {
 			log_local->put_any(category::abc::http, severity::abc::debug, 0x1003e, "_http_istream::_http_istream()");
@@ -98,6 +103,18 @@ namespace abc {
 	}
 
 
+	template <typename Log>
+	inline void _http_istream<Log>::reset(http::item_t next) {
+		base::reset();
+
+		_is_transfer_encoding = false;
+		_chunk_state = http::chunk_state::none;
+		_chunk_size = 0;
+
+		state::reset(next);
+	}
+
+
 	template <typename Log>
 	inline void _http_istream<Log>::set_gstate(std::size_t gcount, http::item_t next) {
 		base::set_gcount(gcount);
@@ -180,10 +197,17 @@ namespace abc {
 		if (gcount == 0) {
 			skip_crlf();
 
+			// The end of the trailers is the end of a chunked body.
+			if (_chunk_state == http::chunk_state::trailer) {
+				_chunk_state = http::chunk_state::done;
+			}
+
 			set_gstate(gcount, http::item::body);
 			return;
 		}
 
+		_is_transfer_encoding = ascii::are_equal_i(buffer, "Transfer-Encoding");
+
 		if (base::is_good()) {
 			char ch = get_char();
 			if (ch != ':') {
@@ -236,6 +260,15 @@ namespace abc {
 
 		skip_spaces();
 
+		// The body is chunked if chunked is the last transfer coding.
+		static constexpr std::size_t chunked_size = 7;
+		if (_is_transfer_encoding && _chunk_state == http::chunk_state::none && gcount >= chunked_size && ascii::are_equal_i_n(buffer + gcount - chunked_size, "chunked", chunked_size)
+			&& (gcount == chunked_size || buffer[gcount - chunked_size - 1] == ' ' || buffer[gcount - chunked_size - 1] == ',')) {
+			_chunk_state = http::chunk_state::size;
+		}
+
+		_is_transfer_encoding = false;
+
 		set_gstate(gcount, http::item::header_name);
 
 		if (log_local != nullptr) {
@@ -253,9 +286,10 @@ namespace abc {
 
 		state::assert_next(http::item::body);
 
-		std::size_t gcount = get_bytes(buffer, size);
+		std::size_t gcount = _chunk_state == http::chunk_state::none ? get_bytes(buffer, size) : get_chunks(buffer, size);
 
-		set_gstate(gcount, http::item::body);
+		// Once a chunked body is over, the trailers are next.
+		set_gstate(gcount, gcount == 0 && _chunk_state == http::chunk_state::trailer ? http::item::header_name : http::item::body);
 
 		if (log_local != nullptr) {
 			log_local->put_any(category::abc::http, severity::abc::optional, 0x10046, "_http_istream::get_body() <<< body='%s', gcount=%lu", buffer, (std::uint32_t)gcount);
@@ -263,21 +297,27 @@ namespace abc {
 	}
 
 
+	template <typename Log>
+	inline bool _http_istream<Log>::is_chunked() const noexcept {
+		return _chunk_state != http::chunk_state::none;
+	}
+
+
 	template <typename Log>
 	inline std::size_t _http_istream<Log>::get_token(char* buffer, std::size_t size) {
-		return get_chars(ascii::http::is_token, buffer, size);
+		return get_chars(ascii::http::is_token, scan::find_non_token, buffer, size);
 	}
 
 
 	template <typename Log>
 	inline std::size_t _http_istream<Log>::get_prints(char* buffer, std::size_t size) {
-		return get_chars(ascii::is_abcprint, buffer, size);
+		return get_chars(ascii::is_abcprint, scan::find_non_print, buffer, size);
 	}
 
 
 	template <typename Log>
 	inline std::size_t _http_istream<Log>::get_prints_and_spaces(char* buffer, std::size_t size) {
-		return get_chars(ascii::is_abcprint_or_space, buffer, size);
+		return get_chars(ascii::is_abcprint_or_space, scan::find_non_print_or_space, buffer, size);
 	}
 
 
@@ -317,6 +357,65 @@ namespace abc {
 	}
 
 
+	template <typename Log>
+	inline std::size_t _http_istream<Log>::get_chunks(char* buffer, std::size_t size) {
+		std::size_t gcount = 0;
+
+		while (base::is_good() && gcount < size) {
+			if (_chunk_state == http::chunk_state::size) {
+				get_chunk_size();
+				continue;
+			}
+
+			if (_chunk_state != http::chunk_state::data) {
+				break;
+			}
+
+			std::size_t gcount_local = get_bytes(buffer + gcount, std::min(size - gcount, _chunk_size));
+			gcount += gcount_local;
+			_chunk_size -= gcount_local;
+
+			// Each chunk's data is followed by a CRLF.
+			if (_chunk_size == 0) {
+				skip_crlf();
+				_chunk_state = http::chunk_state::size;
+			}
+		}
+
+		return gcount;
+	}
+
+
+	template <typename Log>
+	inline void _http_istream<Log>::get_chunk_size() {
+		Log* log_local = state::log();
+
+		std::size_t chunk_size = 0;
+		std::size_t digit_count = 0;
+
+		while (base::is_good() && ascii::is_hex(peek_char())) {
+			chunk_size = (chunk_size << 4) | ascii::hex(get_char());
+			digit_count++;
+		}
+
+		// The size must be there, and it must fit in std::size_t.
+		if (digit_count == 0 || digit_count > 2 * sizeof(std::size_t)) {
+			base::set_bad();
+		}
+
+		// Chunk extensions are ignored.
+		skip_chars([] (char ch) { return ch != '\r' && ch != '\n'; });
+		skip_crlf();
+
+		_chunk_size = chunk_size;
+		_chunk_state = chunk_size > 0 ? http::chunk_state::data : http::chunk_state::trailer;
+
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::http, severity::abc::debug, 0x104a9, "_http_istream::get_chunk_size() chunk_size=%zu", chunk_size);
+		}
+	}
+
+
 	template <typename Log>
 	inline std::size_t _http_istream<Log>::get_bytes(char* buffer, std::size_t size) {
 		std::size_t gcount = 0;
@@ -332,7 +431,15 @@ namespace abc {
 	template <typename Log>
 	template <typename Predicate>
 	inline std::size_t _http_istream<Log>::get_chars(Predicate&& predicate, char* buffer, std::size_t size) {
-		std::size_t gcount = 0;
+		return get_chars(predicate, [&predicate] (const char* begin, const char* end) { return std::find_if_not(begin, end, predicate); }, buffer, size);
+	}
+
+
+	template <typename Log>
+	template <typename Predicate, typename Find>
+	inline std::size_t _http_istream<Log>::get_chars(Predicate&& predicate, Find&& find, char* buffer, std::size_t size) {
+		// Whole runs of buffered chars first, and then one char at a time to deal with the end of the run.
+		std::size_t gcount = base::get_span_run(find, buffer, size - 1);
 
 		while (base::is_good() && predicate(peek_char())) {
 			if (gcount == size - 1) {
@@ -351,8 +458,8 @@ namespace abc {
 	template <typename Log>
 	template <typename Predicate>
 	inline std::size_t _http_istream<Log>::skip_chars(Predicate&& predicate) {
-		std::size_t gcount = 0;
-		
+		std::size_t gcount = base::get_span_chars(predicate, nullptr, size::strlen);
+
 		while (base::is_good() && predicate(peek_char())) {
 			base::get();
 			gcount++;
@@ -393,7 +500,11 @@ namespace abc {
 	template <typename Log>
 	inline _http_ostream<Log>::_http_ostream(std::streambuf* sb, http::item_t next, Log* log)
 		: base(sb)
-		, state(next, log) {
+		, state(next, log)
+		, _flush(http::flush::item)
+		, _head_buffer(nullptr)
+		, _head_capacity(0)
+		, _head_size(0) {
 		Log* log_local = state::log();
 		if (log_local != nullptr) {
 			log_local->put_any(category::abc::http, severity::abc::debug, 0x10047, "_http_ostream::_http_ostream()");
@@ -401,9 +512,35 @@ namespace abc {
 	}
 
 
+	template <typename Log>
+	inline void _http_ostream<Log>::set_flush(http::flush_t flush) noexcept {
+		_flush = flush;
+	}
+
+
+	template <typename Log>
+	inline void _http_ostream<Log>::set_head_buffer(char* buffer, std::size_t size) noexcept {
+		_head_buffer = buffer;
+		_head_capacity = buffer != nullptr ? size : 0;
+		_head_size = 0;
+	}
+
+
+	template <typename Log>
+	inline void _http_ostream<Log>::reset(http::item_t next) {
+		_head_size = 0;
+
+		state::reset(next);
+	}
+
+
 	template <typename Log>
 	inline void _http_ostream<Log>::set_pstate(http::item_t next) {
-		base::flush();
+		// While the head is being assembled in the head buffer, nothing has reached the streambuf yet.
+		if (_flush == http::flush::item && !is_head_buffered()) {
+			base::flush();
+		}
+
 		state::set_next(next);
 	}
 
@@ -445,7 +582,7 @@ namespace abc {
 				base::set_bad();
 			}
 			else {
-				base::put('.');
+				put_char('.');
 				gcount++;
 			}
 		}
@@ -494,7 +631,7 @@ namespace abc {
 		}
 
 		if (base::is_good()) {
-			base::put(':');
+			put_char(':');
 			put_space();
 		}
 
@@ -561,6 +698,22 @@ namespace abc {
 
 		put_crlf();
 
+		if (is_head_buffered()) {
+			if (base::is_good()) {
+				base::write(_head_buffer, _head_size);
+			}
+
+			if (log_local != nullptr) {
+				log_local->put_any(category::abc::http, severity::abc::optional, 0x10496, "_http_ostream::end_headers() head_size=%lu, good=%d", (std::uint32_t)_head_size, base::is_good());
+			}
+
+			_head_size = 0;
+
+			if (_flush == http::flush::item) {
+				base::flush();
+			}
+		}
+
 		set_pstate(http::item::body);
 
 		if (log_local != nullptr) {
@@ -584,7 +737,9 @@ namespace abc {
 
 		std::size_t pcount = put_bytes(buffer, size);
 
-		set_pstate(http::item::body);
+		// The body is always flushed regardless of the flush mode.
+		base::flush();
+		state::set_next(http::item::body);
 
 		if (log_local != nullptr) {
 			log_local->put_any(category::abc::http, severity::abc::optional, 0x10051, "_http_ostream::put_body() <<< buffer='%s', size=%lu, pcount=%lu", buffer, (std::uint32_t)size, (std::uint32_t)pcount);
@@ -592,6 +747,57 @@ namespace abc {
 	}
 
 
+	template <typename Log>
+	inline void _http_ostream<Log>::put_chunk(const char* buffer, std::size_t size) {
+		Log* log_local = state::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::http, severity::abc::debug, 0x104aa, "_http_ostream::put_chunk() >>>");
+		}
+
+		state::assert_next(http::item::body);
+
+		if (size == size::strlen) {
+			size = std::strlen(buffer);
+		}
+
+		std::size_t pcount = 0;
+
+		if (size > 0) {
+			char size_line[2 * sizeof(std::size_t) + 3];
+			int size_line_size = std::snprintf(size_line, sizeof(size_line), "%zx\r\n", size);
+
+			put_bytes(size_line, size_line_size);
+			pcount = put_bytes(buffer, size);
+			put_crlf();
+
+			// Chunks are flushed like the body.
+			base::flush();
+		}
+
+		state::set_next(http::item::body);
+
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::http, severity::abc::optional, 0x104ab, "_http_ostream::put_chunk() <<< size=%zu, pcount=%zu", size, pcount);
+		}
+	}
+
+
+	template <typename Log>
+	inline void _http_ostream<Log>::end_chunks() {
+		Log* log_local = state::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::http, severity::abc::debug, 0x104ac, "_http_ostream::end_chunks()");
+		}
+
+		state::assert_next(http::item::body);
+
+		put_bytes("0\r\n", 3);
+
+		// The trailers are put like headers.
+		set_pstate(http::item::header_name);
+	}
+
+
 	template <typename Log>
 	inline std::size_t _http_ostream<Log>::put_crlf() {
 		return put_char('\r') + put_char('\n');
@@ -636,13 +842,31 @@ namespace abc {
 
 	template <typename Log>
 	inline std::size_t _http_ostream<Log>::put_bytes(const char* buffer, std::size_t size) {
-		std::size_t gcount = 0;
+		if (!base::is_good()) {
+			return 0;
+		}
 
-		while (base::is_good() && gcount < size) {
-			base::put(buffer[gcount++]);
+		if (is_head_buffered()) {
+			if (_head_capacity - _head_size < size) {
+				Log* log_local = state::log();
+				if (log_local != nullptr) {
+					log_local->put_any(category::abc::http, severity::abc::important, 0x10497, "_http_ostream::put_bytes() Head buffer overflow. head_capacity=%lu, head_size=%lu, size=%lu", (std::uint32_t)_head_capacity, (std::uint32_t)_head_size, (std::uint32_t)size);
+				}
+
+				base::set_bad();
+				return 0;
+			}
+
+			std::memcpy(_head_buffer + _head_size, buffer, size);
+			_head_size += size;
+
+			return size;
 		}
 
-		return gcount;
+		// Pass the whole buffer to the streambuf at once, so that it can send it without copying.
+		base::write(buffer, size);
+
+		return base::is_good() ? size : 0;
 	}
 
 
@@ -651,16 +875,20 @@ namespace abc {
 	inline std::size_t _http_ostream<Log>::put_chars(Predicate&& predicate, const char* buffer, std::size_t size) {
 		std::size_t pcount = 0;
 
-		while (base::is_good() && pcount < size && predicate(buffer[pcount])) {
-			base::put(buffer[pcount++]);
+		while (pcount < size && predicate(buffer[pcount])) {
+			pcount++;
 		}
 
-		return pcount;
+		return put_bytes(buffer, pcount);
 	}
 
 
 	template <typename Log>
 	inline std::size_t _http_ostream<Log>::put_char(char ch) {
+		if (is_head_buffered()) {
+			return put_bytes(&ch, 1);
+		}
+
 		if (base::is_good()) {
 			base::put(ch);
 		}
@@ -701,6 +929,13 @@ namespace abc {
 	}
 
 
+	template <typename Log>
+	inline bool _http_ostream<Log>::is_head_buffered() const noexcept {
+		// The body is never buffered - only the items before it.
+		return _head_buffer != nullptr && state::next() != http::item::body;
+	}
+
+
 	// --------------------------------------------------------------
 
 
@@ -1015,7 +1250,314 @@ namespace abc {
 	template <typename Log>
 	inline http_server_stream<Log>::http_server_stream(std::streambuf* sb, Log* log)
 		: http_request_istream<Log>(sb, log)
-		, http_response_ostream<Log>(sb, log) {
+		, http_response_ostream<Log>(sb, log)
+		, _keep_alive(false) {
+	}
+
+
+	template <typename Log>
+	inline void http_server_stream<Log>::reset() {
+		http_request_istream<Log>::reset();
+		http_response_ostream<Log>::reset();
+
+		// A handler may have switched the flush mode for its response, e.g. to flush only the body of a file.
+		http_response_ostream<Log>::set_flush(http::flush::item);
+	}
+
+
+	template <typename Log>
+	inline bool http_server_stream<Log>::keep_alive() const noexcept {
+		return _keep_alive;
+	}
+
+
+	template <typename Log>
+	inline void http_server_stream<Log>::set_keep_alive(bool keep_alive) noexcept {
+		_keep_alive = keep_alive;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <std::size_t Size, typename Log>
+	inline http_chunk_streambuf<Size, Log>::http_chunk_streambuf(_http_ostream<Log>* http)
+		: _http(http) {
+		if (http == nullptr) {
+			throw exception<std::logic_error, Log>("http", 0x104ad);
+		}
+
+		setp(_buffer, _buffer + Size);
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline std::streambuf::int_type http_chunk_streambuf<Size, Log>::overflow(std::streambuf::int_type ch) {
+		put_chunk();
+
+		if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(ch);
+			pbump(1);
+		}
+
+		return _http->good() ? traits_type::not_eof(ch) : traits_type::eof();
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline void http_chunk_streambuf<Size, Log>::end_chunks() {
+		put_chunk();
+
+		_http->end_chunks();
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline void http_chunk_streambuf<Size, Log>::put_chunk() {
+		_http->put_chunk(pbase(), pptr() - pbase());
+
+		setp(_buffer, _buffer + Size);
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline http_request_parser<MaxHeaders, Log>::http_request_parser(Log* log)
+		: _log(log) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::http, severity::abc::debug, 0x10472, "http_request_parser::http_request_parser()");
+		}
+
+		reset();
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline void http_request_parser<MaxHeaders, Log>::reset() noexcept {
+		_buffer = nullptr;
+		_line_pos = 0;
+		_scan_pos = 0;
+		_status = http::parse_status::need_more;
+		_head_size = 0;
+		_method = _span { 0, 0 };
+		_resource = _span { 0, 0 };
+		_protocol = _span { 0, 0 };
+		_header_count = 0;
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline http::parse_status_t http_request_parser<MaxHeaders, Log>::parse(const char* buffer, std::size_t size) {
+		_buffer = buffer;
+
+		if (_status != http::parse_status::need_more) {
+			return _status;
+		}
+
+		// Each complete line is parsed as a whole. An incomplete line is parsed again once its end has been received.
+		while (_scan_pos < size) {
+			const char* lf = static_cast<const char*>(std::memchr(buffer + _scan_pos, '\n', size - _scan_pos));
+			if (lf == nullptr) {
+				_scan_pos = size;
+				break;
+			}
+
+			std::size_t lf_pos = lf - buffer;
+			_scan_pos = lf_pos + 1;
+
+			if (lf_pos == _line_pos || buffer[lf_pos - 1] != '\r') {
+				_status = http::parse_status::bad;
+				break;
+			}
+
+			std::size_t line_end = lf_pos - 1;
+			bool is_request_line_parsed = _protocol.size > 0;
+
+			if (line_end == _line_pos) {
+				_status = is_request_line_parsed ? http::parse_status::done : http::parse_status::bad;
+				_head_size = _scan_pos;
+				break;
+			}
+
+			bool is_good = is_request_line_parsed ? parse_header_line(_line_pos, line_end) : parse_request_line(_line_pos, line_end);
+			if (!is_good) {
+				_status = http::parse_status::bad;
+				break;
+			}
+
+			_line_pos = _scan_pos;
+		}
+
+		if (_log != nullptr) {
+			_log->put_any(category::abc::http, severity::abc::optional, 0x10473, "http_request_parser::parse() status=%u, size=%zu, header_count=%zu, head_size=%zu", _status, size, _header_count, _head_size);
+		}
+
+		return _status;
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline bool http_request_parser<MaxHeaders, Log>::parse_request_line(std::size_t begin, std::size_t end) noexcept {
+		const char* buffer = _buffer;
+		std::size_t pos = begin;
+
+		pos = scan::find_non_token(buffer + pos, buffer + end) - buffer;
+		_method = _span { begin, pos - begin };
+
+		if (_method.size == 0 || pos == end || !ascii::is_space(buffer[pos])) {
+			return false;
+		}
+
+		while (pos < end && ascii::is_space(buffer[pos])) {
+			pos++;
+		}
+
+		std::size_t resource_pos = pos;
+		pos = scan::find_non_print(buffer + pos, buffer + end) - buffer;
+		_resource = _span { resource_pos, pos - resource_pos };
+
+		if (_resource.size == 0 || pos == end || !ascii::is_space(buffer[pos])) {
+			return false;
+		}
+
+		while (pos < end && ascii::is_space(buffer[pos])) {
+			pos++;
+		}
+
+		// HTTP/<digits>.<digits>
+		std::size_t protocol_pos = pos;
+		if (end - pos < 5 || !ascii::are_equal_i_n(buffer + pos, "HTTP/", 5)) {
+			return false;
+		}
+		pos += 5;
+
+		std::size_t digits_pos = pos;
+		while (pos < end && ascii::is_digit(buffer[pos])) {
+			pos++;
+		}
+
+		if (pos == digits_pos || pos == end || buffer[pos] != '.') {
+			return false;
+		}
+		pos++;
+
+		digits_pos = pos;
+		while (pos < end && ascii::is_digit(buffer[pos])) {
+			pos++;
+		}
+
+		if (pos == digits_pos) {
+			return false;
+		}
+		_protocol = _span { protocol_pos, pos - protocol_pos };
+
+		while (pos < end && ascii::is_space(buffer[pos])) {
+			pos++;
+		}
+
+		return pos == end;
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline bool http_request_parser<MaxHeaders, Log>::parse_header_line(std::size_t begin, std::size_t end) noexcept {
+		const char* buffer = _buffer;
+		std::size_t pos = begin;
+
+		// A line that starts with a space would continue the value of the previous header (obs-fold), and a space before the ':' is not allowed either.
+		// A server must reject both (RFC 7230, 3.2.4), because a proxy in front of it may take the line as part of a different header.
+		pos = scan::find_non_token(buffer + pos, buffer + end) - buffer;
+
+		if (pos == begin || pos == end || buffer[pos] != ':' || _header_count == MaxHeaders) {
+			return false;
+		}
+
+		_headers[_header_count].name = _span { begin, pos - begin };
+		pos++;
+
+		while (pos < end && ascii::is_space(buffer[pos])) {
+			pos++;
+		}
+
+		std::size_t value_pos = pos;
+		if (scan::find_non_print_or_space(buffer + pos, buffer + end) != buffer + end) {
+			return false;
+		}
+
+		std::size_t value_end = end;
+		while (value_end > value_pos && ascii::is_space(buffer[value_end - 1])) {
+			value_end--;
+		}
+
+		_headers[_header_count++].value = _span { value_pos, value_end - value_pos };
+
+		return true;
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline std::size_t http_request_parser<MaxHeaders, Log>::head_size() const noexcept {
+		return _head_size;
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline char_span http_request_parser<MaxHeaders, Log>::method() const noexcept {
+		return span(_method.pos, _method.size);
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline char_span http_request_parser<MaxHeaders, Log>::resource() const noexcept {
+		return span(_resource.pos, _resource.size);
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline char_span http_request_parser<MaxHeaders, Log>::protocol() const noexcept {
+		return span(_protocol.pos, _protocol.size);
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline std::size_t http_request_parser<MaxHeaders, Log>::header_count() const noexcept {
+		return _header_count;
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline http::header http_request_parser<MaxHeaders, Log>::header(std::size_t index) const noexcept {
+		if (index >= _header_count) {
+			return http::header { char_span { nullptr, 0 }, char_span { nullptr, 0 } };
+		}
+
+		const _header& header = _headers[index];
+		return http::header { span(header.name.pos, header.name.size), span(header.value.pos, header.value.size) };
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline char_span http_request_parser<MaxHeaders, Log>::find_header(const char* name, std::size_t size) const noexcept {
+		if (size == size::strlen) {
+			size = std::strlen(name);
+		}
+
+		for (std::size_t i = 0; i < _header_count; i++) {
+			const _header& header = _headers[i];
+			if (header.name.size == size && ascii::are_equal_i_n(_buffer + header.name.pos, name, size)) {
+				return span(header.value.pos, header.value.size);
+			}
+		}
+
+		return char_span { nullptr, 0 };
+	}
+
+
+	template <std::size_t MaxHeaders, typename Log>
+	inline char_span http_request_parser<MaxHeaders, Log>::span(std::size_t pos, std::size_t size) const noexcept {
+		return char_span { _buffer != nullptr ? _buffer + pos : nullptr, size };
 	}
 
 }
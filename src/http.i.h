@@ -48,6 +48,55 @@ namespace abc {
 			constexpr item_t header_value	= 6;
 			constexpr item_t body			= 7;
 		}
+
+
+		using flush_t = std::uint8_t;
+
+		namespace flush {
+			// Flush after every item. This is the default.
+			constexpr flush_t item			= 0;
+
+			// Flush only after body chunks. The head accumulates in the streambuf, so it goes out together
+			// with the first body chunk - in a single vectored write when the streambuf is a socket_streambuf.
+			constexpr flush_t body			= 1;
+		}
+
+
+		using chunk_state_t = std::uint8_t;
+
+		namespace chunk_state {
+			// The body is not chunked.
+			constexpr chunk_state_t none	= 0;
+
+			// A chunk size line is next.
+			constexpr chunk_state_t size	= 1;
+
+			// Chunk data is next.
+			constexpr chunk_state_t data	= 2;
+
+			// The last chunk has been read. Trailers are next.
+			constexpr chunk_state_t trailer	= 3;
+
+			// The trailers have been read. The body is over.
+			constexpr chunk_state_t done	= 4;
+		}
+
+
+		using parse_status_t = std::uint8_t;
+
+		namespace parse_status {
+			// The head is incomplete. Call parse() again once more bytes have been received.
+			constexpr parse_status_t need_more	= 0;
+			constexpr parse_status_t done		= 1;
+			constexpr parse_status_t bad		= 2;
+		}
+
+
+		// A header whose name and value point into the buffer that was parsed.
+		struct header {
+			char_span		name;
+			char_span		value;
+		};
 	}
 
 
@@ -91,9 +140,15 @@ namespace abc {
 	public:
 		void		get_header_name(char* buffer, std::size_t size);
 		void		get_header_value(char* buffer, std::size_t size);
+
+		// If the headers included "Transfer-Encoding: chunked", the chunks are decoded, and only their data is returned.
+		// The end of the body is signaled by gcount() == 0. Then the trailers, if any, can be read as headers.
 		void		get_body(char* buffer, std::size_t size);
 
+		bool		is_chunked() const noexcept;
+
 	protected:
+		void		reset(http::item_t next);
 		void		set_gstate(std::size_t gcount, http::item_t next);
 
 		std::size_t	get_protocol(char* buffer, std::size_t size);
@@ -107,13 +162,23 @@ namespace abc {
 		std::size_t	skip_spaces();
 		std::size_t	skip_crlf();
 
+		std::size_t	get_chunks(char* buffer, std::size_t size);
+		void		get_chunk_size();
+
 		std::size_t	get_bytes(char* buffer, std::size_t size);
 		template <typename Predicate>
 		std::size_t	get_chars(Predicate&& predicate, char* buffer, std::size_t size);
+		template <typename Predicate, typename Find>
+		std::size_t	get_chars(Predicate&& predicate, Find&& find, char* buffer, std::size_t size);
 		template <typename Predicate>
 		std::size_t	skip_chars(Predicate&& predicate);
 		char		get_char();
 		char		peek_char();
+
+	private:
+		bool				_is_transfer_encoding;
+		http::chunk_state_t	_chunk_state;
+		std::size_t			_chunk_size;
 	};
 
 
@@ -135,7 +200,22 @@ namespace abc {
 		void		end_headers();
 		void		put_body(const char* buffer, std::size_t size = size::strlen);
 
+		// Puts the body as chunks, when its size isn't known up front. The headers should include "Transfer-Encoding: chunked".
+		// A chunk of size 0 is skipped, since it would end the body.
+		void		put_chunk(const char* buffer, std::size_t size = size::strlen);
+
+		// Puts the last chunk. Trailers may follow as headers, and end_headers() ends the body.
+		void		end_chunks();
+
+		void		set_flush(http::flush_t flush) noexcept;
+
+		// Assembles the head in the given buffer instead of writing it item by item to the streambuf.
+		// The whole head is written to the streambuf at once by end_headers(). If the head doesn't fit, the stream goes bad.
+		// The buffer is reused for subsequent heads until set_head_buffer(nullptr, 0) is called.
+		void		set_head_buffer(char* buffer, std::size_t size) noexcept;
+
 	protected:
+		void		reset(http::item_t next);
 		void		set_pstate(http::item_t next);
 
 		std::size_t	put_protocol(const char* buffer, std::size_t size);
@@ -155,6 +235,14 @@ namespace abc {
 
 		std::size_t skip_spaces_in_header_value(const char* buffer, std::size_t size);
 		std::size_t skip_spaces(const char* buffer, std::size_t size);
+
+		bool		is_head_buffered() const noexcept;
+
+	private:
+		http::flush_t _flush;
+		char*		_head_buffer;
+		std::size_t	_head_capacity;
+		std::size_t	_head_size;
 	};
 
 
@@ -257,6 +345,110 @@ namespace abc {
 	public:
 		http_server_stream(std::streambuf* sb, Log* log = nullptr);
 		http_server_stream(http_server_stream&& other) = default;
+
+		// Gets both directions ready for the next request on the same connection, and restores the default flush mode.
+		void	reset();
+
+	public:
+		// Whether the connection stays open after the current response. The response should announce it in its Connection header.
+		bool	keep_alive() const noexcept;
+		void	set_keep_alive(bool keep_alive) noexcept;
+
+	private:
+		bool	_keep_alive;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	// Puts whatever is written to it as chunks of the body of an http ostream, Size bytes per chunk.
+	// That lets a json_ostream, or any other stream, write a body whose size isn't known up front straight to the http ostream.
+	// sync() doesn't put a chunk, because json_ostream flushes after every token. end_chunks() puts the rest and the last chunk.
+	template <std::size_t Size = size::k1, typename Log = null_log>
+	class http_chunk_streambuf : public std::streambuf {
+		static_assert(Size > 0, "Size must be positive.");
+
+	public:
+		http_chunk_streambuf(_http_ostream<Log>* http);
+
+	public:
+		// Trailers may follow as headers on the http ostream, and end_headers() ends the body.
+		void				end_chunks();
+
+	protected:
+		virtual int_type	overflow(int_type ch) override;
+
+	private:
+		void				put_chunk();
+
+	private:
+		_http_ostream<Log>*	_http;
+		char				_buffer[Size];
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	// Parses a request head - the request line and the headers - that is in a contiguous buffer.
+	// Unlike http_request_istream, nothing is copied. The method, the resource, the protocol, and the headers are views into the buffer.
+	// Parsing is incremental. When the head is incomplete, parse() returns need_more, and it resumes from the last complete line on the next call.
+	// The buffer may move between calls, e.g. when it gets compacted, as long as it keeps the bytes from the start of the head.
+	// The views point into the buffer that was passed to the last parse() call.
+	// Header values are trimmed, but spaces inside a value are not collapsed.
+	// A header line that is folded onto the next line, or that has a space before the ':', makes the head bad.
+	template <std::size_t MaxHeaders = size::_32, typename Log = null_log>
+	class http_request_parser {
+	public:
+		http_request_parser(Log* log = nullptr);
+
+		void					reset() noexcept;
+
+	public:
+		http::parse_status_t	parse(const char* buffer, std::size_t size);
+
+		// The number of bytes the head takes, including the empty line. The body starts there.
+		std::size_t				head_size() const noexcept;
+
+		char_span				method() const noexcept;
+		char_span				resource() const noexcept;
+		char_span				protocol() const noexcept;
+
+		std::size_t				header_count() const noexcept;
+		http::header			header(std::size_t index) const noexcept;
+
+		// Finds the first header with the given name, ignoring case. If there is none, the returned value's data is nullptr.
+		char_span				find_header(const char* name, std::size_t size = size::strlen) const noexcept;
+
+	private:
+		bool					parse_request_line(std::size_t begin, std::size_t end) noexcept;
+		bool					parse_header_line(std::size_t begin, std::size_t end) noexcept;
+		char_span				span(std::size_t pos, std::size_t size) const noexcept;
+
+	private:
+		struct _span {
+			std::size_t			pos;
+			std::size_t			size;
+		};
+
+		struct _header {
+			_span				name;
+			_span				value;
+		};
+
+	private:
+		const char*				_buffer;
+		std::size_t				_line_pos;
+		std::size_t				_scan_pos;
+		http::parse_status_t	_status;
+		std::size_t				_head_size;
+		_span					_method;
+		_span					_resource;
+		_span					_protocol;
+		std::size_t				_header_count;
+		_header					_headers[MaxHeaders];
+		Log*					_log;
 	};
 
 }
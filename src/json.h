@@ -582,7 +582,8 @@ namespace abc {
 	template <std::size_t MaxLevels, typename Log>
 	template <typename Predicate>
 	inline std::size_t json_istream<MaxLevels, Log>::get_chars(Predicate&& predicate, char* buffer, std::size_t size) {
-		std::size_t gcount = 0;
+		// Whole runs of buffered chars first, and then one char at a time to deal with the end of the run.
+		std::size_t gcount = base::get_span_chars(predicate, buffer, size - 1);
 
 		while (base::is_good() && predicate(peek_char())) {
 			if (gcount == size - 1) {
@@ -601,8 +602,8 @@ namespace abc {
 	template <std::size_t MaxLevels, typename Log>
 	template <typename Predicate>
 	inline std::size_t json_istream<MaxLevels, Log>::skip_chars(Predicate&& predicate) {
-		std::size_t gcount = 0;
-		
+		std::size_t gcount = base::get_span_chars(predicate, nullptr, size::strlen);
+
 		while (base::is_good() && predicate(peek_char())) {
 			base::get();
 			gcount++;
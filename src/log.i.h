@@ -92,6 +92,11 @@ namespace abc {
 			constexpr category_t multifile	= base + 6;
 			constexpr category_t endpoint	= base + 7;
 			constexpr category_t samples	= base + 8;
+			constexpr category_t reactor	= base + 9;
+			constexpr category_t uring		= base + 10;
+			constexpr category_t pool		= base + 11;
+			constexpr category_t ring		= base + 12;
+			constexpr category_t timer		= base + 13;
 		}
 	}
 
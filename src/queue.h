@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "queue.i.h"
+
+
+namespace abc {
+
+	template <typename T, std::size_t Size>
+	inline mpmc_queue<T, Size>::mpmc_queue() noexcept
+		: _push_pos(0)
+		, _pop_pos(0)
+		, _waiting_count(0) {
+		// Each cell's sequence tells which position may use it next.
+		for (std::size_t i = 0; i < Size; i++) {
+			_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+
+	template <typename T, std::size_t Size>
+	inline bool mpmc_queue<T, Size>::try_push(const T& item) noexcept {
+		std::size_t pos = _push_pos.load(std::memory_order_relaxed);
+
+		while (true) {
+			cell& c = _cells[pos & (Size - 1)];
+			std::size_t sequence = c.sequence.load(std::memory_order_acquire);
+			std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+
+			if (diff == 0) {
+				// The cell is free. Claim the position.
+				if (_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					c.item = item;
+					c.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				// The cell hasn't been popped since the last lap.
+				return false;
+			}
+			else {
+				// Another producer claimed the position.
+				pos = _push_pos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+
+	template <typename T, std::size_t Size>
+	inline bool mpmc_queue<T, Size>::try_pop(T& item) noexcept {
+		std::size_t pos = _pop_pos.load(std::memory_order_relaxed);
+
+		while (true) {
+			cell& c = _cells[pos & (Size - 1)];
+			std::size_t sequence = c.sequence.load(std::memory_order_acquire);
+			std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+
+			if (diff == 0) {
+				// The cell is full. Claim the position.
+				if (_pop_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					item = c.item;
+					c.sequence.store(pos + Size, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				// The cell hasn't been pushed yet.
+				return false;
+			}
+			else {
+				// Another consumer claimed the position.
+				pos = _pop_pos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+
+	template <typename T, std::size_t Size>
+	inline void mpmc_queue<T, Size>::pop(T& item) {
+		if (try_pop(item)) {
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_waiting_count++;
+
+		// try_pop() is retried under the lock, so a notify() that happens in between is not missed.
+		while (!try_pop(item)) {
+			_condition.wait(lock);
+		}
+
+		_waiting_count--;
+	}
+
+
+	template <typename T, std::size_t Size>
+	inline void mpmc_queue<T, Size>::notify() {
+		// Orders the preceding push before reading the waiting count.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (_waiting_count.load() > 0) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			_condition.notify_all();
+		}
+	}
+
+}
@@ -0,0 +1,79 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "size.h"
+
+
+namespace abc {
+
+	// A bounded multi-producer/multi-consumer queue.
+	// try_push() and try_pop() are lock-free. Only pop() takes a lock, and only while the queue is empty.
+	template <typename T, std::size_t Size = size::_256>
+	class mpmc_queue {
+		static_assert(Size > 0 && (Size & (Size - 1)) == 0, "Size must be a power of 2.");
+
+	public:
+		mpmc_queue() noexcept;
+		mpmc_queue(mpmc_queue&& other) = delete;
+		mpmc_queue(const mpmc_queue& other) = delete;
+
+	public:
+		// Returns false if the queue is full.
+		bool			try_push(const T& item) noexcept;
+
+		// Returns false if the queue is empty.
+		bool			try_pop(T& item) noexcept;
+
+		// Blocks until an item is available.
+		void			pop(T& item);
+
+		// Wakes up the consumers that are blocked in pop(). Producers call it after pushing a batch.
+		void			notify();
+
+	private:
+		struct cell {
+			std::atomic_size_t	sequence;
+			T					item;
+		};
+
+	private:
+		cell						_cells[Size];
+		alignas(size::_64) std::atomic_size_t	_push_pos;
+		alignas(size::_64) std::atomic_size_t	_pop_pos;
+
+		std::mutex					_mutex;
+		std::condition_variable		_condition;
+		std::atomic_size_t			_waiting_count;
+	};
+
+}
@@ -0,0 +1,199 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <stdexcept>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "reactor.i.h"
+#include "exception.h"
+
+
+namespace abc {
+
+	template <std::size_t MaxEvents, typename Log>
+	inline reactor<MaxEvents, Log>::reactor(Log* log)
+		: _epoll(-1)
+		, _stop_event(-1)
+		, _is_stopped(false)
+		, _log(log) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::reactor, severity::abc::debug, 0x10358, "reactor::reactor()");
+		}
+
+		_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+		if (_epoll < 0) {
+			throw exception<std::runtime_error, Log>("::epoll_create1()", 0x10359, _log);
+		}
+
+		// The stop event is never reset, so once signaled, it wakes up every thread that runs this reactor.
+		_stop_event = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if (_stop_event < 0) {
+			::close(_epoll);
+			throw exception<std::runtime_error, Log>("::eventfd()", 0x1035a, _log);
+		}
+
+		epoll_event ev = { 0 };
+		ev.events = EPOLLIN;
+		ev.data.ptr = nullptr;
+
+		if (::epoll_ctl(_epoll, EPOLL_CTL_ADD, _stop_event, &ev) != 0) {
+			::close(_stop_event);
+			::close(_epoll);
+			throw exception<std::runtime_error, Log>("::epoll_ctl()", 0x1035b, _log);
+		}
+	}
+
+
+	template <std::size_t MaxEvents, typename Log>
+	inline reactor<MaxEvents, Log>::~reactor() noexcept {
+		::close(_stop_event);
+		::close(_epoll);
+
+		if (_log != nullptr) {
+			_log->put_any(category::abc::reactor, severity::abc::debug, 0x1035c, "reactor::~reactor()");
+		}
+	}
+
+
+	template <std::size_t MaxEvents, typename Log>
+	inline void reactor<MaxEvents, Log>::add(socket::handle_t handle, event_t events, reactor_handler* handler) {
+		control(EPOLL_CTL_ADD, handle, events, handler);
+	}
+
+
+	template <std::size_t MaxEvents, typename Log>
+	inline void reactor<MaxEvents, Log>::modify(socket::handle_t handle, event_t events, reactor_handler* handler) {
+		control(EPOLL_CTL_MOD, handle, events, handler);
+	}
+
+
+	template <std::size_t MaxEvents, typename Log>
+	inline void reactor<MaxEvents, Log>::remove(socket::handle_t handle) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::reactor, severity::abc::debug, 0x1035d, "reactor::remove() handle=%d", handle);
+		}
+
+		if (::epoll_ctl(_epoll, EPOLL_CTL_DEL, handle, nullptr) != 0) {
+			throw exception<std::runtime_error, Log>("::epoll_ctl(EPOLL_CTL_DEL)", 0x1035e, _log);
+		}
+	}
+
+
+	template <std::size_t MaxEvents, typename Log>
+	inline void reactor<MaxEvents, Log>::control(int op, socket::handle_t handle, event_t events, reactor_handler* handler) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::reactor, severity::abc::debug, 0x1035f, "reactor::control() op=%d, handle=%d, events=%x", op, handle, events);
+		}
+
+		if (handler == nullptr) {
+			throw exception<std::logic_error, Log>("handler", 0x10360, _log);
+		}
+
+		epoll_event ev = { 0 };
+		ev.events = events;
+		ev.data.ptr = handler;
+
+		if (::epoll_ctl(_epoll, op, handle, &ev) != 0) {
+			throw exception<std::runtime_error, Log>("::epoll_ctl()", 0x10361, _log);
+		}
+	}
+
+
+	template <std::size_t MaxEvents, typename Log>
+	inline std::size_t reactor<MaxEvents, Log>::run_once(int timeout_ms) {
+		if (is_stopped()) {
+			return 0;
+		}
+
+		epoll_event events[MaxEvents];
+		int event_count = ::epoll_wait(_epoll, events, MaxEvents, timeout_ms);
+
+		if (event_count < 0) {
+			if (errno == EINTR) {
+				return 0;
+			}
+
+			throw exception<std::runtime_error, Log>("::epoll_wait()", 0x10362, _log);
+		}
+
+		std::size_t dispatch_count = 0;
+		for (int i = 0; i < event_count; i++) {
+			reactor_handler* handler = static_cast<reactor_handler*>(events[i].data.ptr);
+
+			// The stop event carries no handler.
+			if (handler == nullptr) {
+				continue;
+			}
+
+			handler->on_event(events[i].events);
+			dispatch_count++;
+		}
+
+		return dispatch_count;
+	}
+
+
+	template <std::size_t MaxEvents, typename Log>
+	inline void reactor<MaxEvents, Log>::run() {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::reactor, severity::abc::optional, 0x10363, "reactor::run() >>>");
+		}
+
+		while (!is_stopped()) {
+			run_once();
+		}
+
+		if (_log != nullptr) {
+			_log->put_any(category::abc::reactor, severity::abc::optional, 0x10364, "reactor::run() <<<");
+		}
+	}
+
+
+	template <std::size_t MaxEvents, typename Log>
+	inline void reactor<MaxEvents, Log>::stop() {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::reactor, severity::abc::optional, 0x10365, "reactor::stop()");
+		}
+
+		_is_stopped.store(true);
+
+		std::uint64_t one = 1;
+		ssize_t written = ::write(_stop_event, &one, sizeof(one));
+		(void)written;
+	}
+
+
+	template <std::size_t MaxEvents, typename Log>
+	inline bool reactor<MaxEvents, Log>::is_stopped() const noexcept {
+		return _is_stopped.load();
+	}
+
+}
@@ -0,0 +1,98 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <sys/epoll.h>
+
+#include "size.h"
+#include "socket.i.h"
+#include "log.i.h"
+
+
+namespace abc {
+
+	using event_t = std::uint32_t;
+
+	namespace event {
+		constexpr event_t	readable	= EPOLLIN;
+		constexpr event_t	writable	= EPOLLOUT;
+		constexpr event_t	closed		= EPOLLRDHUP | EPOLLHUP;
+		constexpr event_t	error		= EPOLLERR;
+
+		// Flags that may be combined with the above when registering a handle.
+		constexpr event_t	edge		= EPOLLET;
+		constexpr event_t	oneshot		= EPOLLONESHOT;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	// A handler is registered together with a handle, and it is expected to know its own handle.
+	class reactor_handler {
+	public:
+		virtual ~reactor_handler() noexcept = default;
+
+		virtual void on_event(event_t events) = 0;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	template <std::size_t MaxEvents = size::_64, typename Log = null_log>
+	class reactor {
+	public:
+		reactor(Log* log = nullptr);
+		reactor(reactor&& other) = delete;
+		reactor(const reactor& other) = delete;
+
+		~reactor() noexcept;
+
+	public:
+		void			add(socket::handle_t handle, event_t events, reactor_handler* handler);
+		void			modify(socket::handle_t handle, event_t events, reactor_handler* handler);
+		void			remove(socket::handle_t handle);
+
+		std::size_t		run_once(int timeout_ms = -1);
+		void			run();
+		void			stop();
+		bool			is_stopped() const noexcept;
+
+	private:
+		void			control(int op, socket::handle_t handle, event_t events, reactor_handler* handler);
+
+	private:
+		int				_epoll;
+		int				_stop_event;
+		std::atomic_bool _is_stopped;
+		Log*			_log;
+	};
+
+}
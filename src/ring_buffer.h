@@ -0,0 +1,181 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "ring_buffer.i.h"
+#include "exception.h"
+
+
+namespace abc {
+
+	template <typename Log>
+	inline ring_buffer<Log>::ring_buffer(std::size_t capacity, Log* log)
+		: _base(nullptr)
+		, _capacity(0)
+		, _read_pos(0)
+		, _size(0)
+		, _log(log) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::ring, severity::abc::debug, 0x10400, "ring_buffer::ring_buffer() >>> capacity=%zu", capacity);
+		}
+
+		if (capacity == 0) {
+			throw exception<std::logic_error, Log>("ring_buffer::ring_buffer() capacity", 0x10401, _log);
+		}
+
+		// Both mappings must start at a page boundary.
+		std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+		_capacity = (capacity + page_size - 1) / page_size * page_size;
+
+		int fd = ::memfd_create("abc::ring_buffer", MFD_CLOEXEC);
+		if (fd < 0) {
+			throw exception<std::runtime_error, Log>("::memfd_create()", 0x10402, _log);
+		}
+
+		if (::ftruncate(fd, static_cast<off_t>(_capacity)) != 0) {
+			::close(fd);
+			throw exception<std::runtime_error, Log>("::ftruncate()", 0x10403, _log);
+		}
+
+		// Reserve a range twice the capacity, and map the same memory into each half.
+		void* base = ::mmap(nullptr, 2 * _capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (base == MAP_FAILED) {
+			::close(fd);
+			throw exception<std::runtime_error, Log>("::mmap() reserve", 0x10404, _log);
+		}
+
+		char* first = static_cast<char*>(base);
+		char* second = first + _capacity;
+
+		if (::mmap(first, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+			|| ::mmap(second, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+			::munmap(base, 2 * _capacity);
+			::close(fd);
+			throw exception<std::runtime_error, Log>("::mmap() mirror", 0x10405, _log);
+		}
+
+		// The mappings keep the memory alive.
+		::close(fd);
+
+		_base = first;
+
+		if (_log != nullptr) {
+			_log->put_any(category::abc::ring, severity::abc::debug, 0x10406, "ring_buffer::ring_buffer() <<< capacity=%zu", _capacity);
+		}
+	}
+
+
+	template <typename Log>
+	inline ring_buffer<Log>::ring_buffer(ring_buffer&& other) noexcept
+		: _base(other._base)
+		, _capacity(other._capacity)
+		, _read_pos(other._read_pos)
+		, _size(other._size)
+		, _log(other._log) {
+		other._base = nullptr;
+		other._capacity = 0;
+		other._read_pos = 0;
+		other._size = 0;
+	}
+
+
+	template <typename Log>
+	inline ring_buffer<Log>::~ring_buffer() noexcept {
+		if (_base != nullptr) {
+			::munmap(_base, 2 * _capacity);
+			_base = nullptr;
+		}
+	}
+
+
+	template <typename Log>
+	inline std::size_t ring_buffer<Log>::capacity() const noexcept {
+		return _capacity;
+	}
+
+
+	template <typename Log>
+	inline char* ring_buffer<Log>::data() noexcept {
+		return _base + _read_pos;
+	}
+
+
+	template <typename Log>
+	inline std::size_t ring_buffer<Log>::size() const noexcept {
+		return _size;
+	}
+
+
+	template <typename Log>
+	inline char* ring_buffer<Log>::space() noexcept {
+		// _read_pos < _capacity and _size <= _capacity, so this stays within the second mapping.
+		return _base + _read_pos + _size;
+	}
+
+
+	template <typename Log>
+	inline std::size_t ring_buffer<Log>::space_size() const noexcept {
+		return _capacity - _size;
+	}
+
+
+	template <typename Log>
+	inline void ring_buffer<Log>::commit(std::size_t size) {
+		if (size > space_size()) {
+			throw exception<std::logic_error, Log>("ring_buffer::commit() size", 0x10407, _log);
+		}
+
+		_size += size;
+	}
+
+
+	template <typename Log>
+	inline void ring_buffer<Log>::consume(std::size_t size) {
+		if (size > _size) {
+			throw exception<std::logic_error, Log>("ring_buffer::consume() size", 0x10408, _log);
+		}
+
+		_size -= size;
+		_read_pos += size;
+
+		if (_read_pos >= _capacity) {
+			_read_pos -= _capacity;
+		}
+	}
+
+
+	template <typename Log>
+	inline void ring_buffer<Log>::clear() noexcept {
+		_read_pos = 0;
+		_size = 0;
+	}
+
+}
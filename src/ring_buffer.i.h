@@ -0,0 +1,74 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstddef>
+
+#include "log.i.h"
+
+
+namespace abc {
+
+	// A ring buffer whose memory is mapped twice, back to back.
+	// The readable bytes, as well as the writable space, are always contiguous, even when they wrap around.
+	// The capacity is rounded up to a whole number of pages.
+	template <typename Log = null_log>
+	class ring_buffer {
+	public:
+		ring_buffer(std::size_t capacity, Log* log = nullptr);
+		ring_buffer(ring_buffer&& other) noexcept;
+		ring_buffer(const ring_buffer& other) = delete;
+		~ring_buffer() noexcept;
+
+	public:
+		std::size_t		capacity() const noexcept;
+
+		// The readable bytes.
+		char*			data() noexcept;
+		std::size_t		size() const noexcept;
+
+		// The writable space that follows the readable bytes.
+		char*			space() noexcept;
+		std::size_t		space_size() const noexcept;
+
+		// Makes size bytes written to space() readable.
+		void			commit(std::size_t size);
+
+		// Releases size bytes from the front of data().
+		void			consume(std::size_t size);
+
+		void			clear() noexcept;
+
+	private:
+		char*			_base;
+		std::size_t		_capacity;
+		std::size_t		_read_pos;
+		std::size_t		_size;
+		Log*			_log;
+	};
+
+}
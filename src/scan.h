@@ -0,0 +1,238 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "ascii.h"
+#include "scan.i.h"
+
+
+namespace abc {
+
+	namespace scan {
+
+		struct _token_class {
+			static bool is_member(char ch) noexcept {
+				return ascii::http::is_token(ch);
+			}
+
+#if defined(__x86_64__)
+			static __m128i is_member_sse2(__m128i chars) noexcept {
+				__m128i is_print = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(0x20)), _mm_cmplt_epi8(chars, _mm_set1_epi8(0x7f)));
+
+				// Spaces are not printable, so only the other separators need to be checked.
+				constexpr char separators[] = "()<>[]{}@,;:\\/\"?=";
+				__m128i is_separator = _mm_setzero_si128();
+				for (std::size_t i = 0; i < sizeof(separators) - 1; i++) {
+					is_separator = _mm_or_si128(is_separator, _mm_cmpeq_epi8(chars, _mm_set1_epi8(separators[i])));
+				}
+
+				return _mm_andnot_si128(is_separator, is_print);
+			}
+
+			__attribute__((target("avx2")))
+			static __m256i is_member_avx2(__m256i chars) noexcept {
+				__m256i is_print = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(0x20)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x7f), chars));
+
+				constexpr char separators[] = "()<>[]{}@,;:\\/\"?=";
+				__m256i is_separator = _mm256_setzero_si256();
+				for (std::size_t i = 0; i < sizeof(separators) - 1; i++) {
+					is_separator = _mm256_or_si256(is_separator, _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(separators[i])));
+				}
+
+				return _mm256_andnot_si256(is_separator, is_print);
+			}
+#endif
+		};
+
+
+		struct _print_class {
+			static bool is_member(char ch) noexcept {
+				return ascii::is_abcprint(ch);
+			}
+
+#if defined(__x86_64__)
+			// Chars are signed, so the chars above 0x7f fail the first comparison.
+			static __m128i is_member_sse2(__m128i chars) noexcept {
+				return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(0x20)), _mm_cmplt_epi8(chars, _mm_set1_epi8(0x7f)));
+			}
+
+			__attribute__((target("avx2")))
+			static __m256i is_member_avx2(__m256i chars) noexcept {
+				return _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(0x20)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x7f), chars));
+			}
+#endif
+		};
+
+
+		struct _print_or_space_class {
+			static bool is_member(char ch) noexcept {
+				return ascii::is_abcprint_or_space(ch);
+			}
+
+#if defined(__x86_64__)
+			static __m128i is_member_sse2(__m128i chars) noexcept {
+				__m128i is_print_or_sp = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(0x1f)), _mm_cmplt_epi8(chars, _mm_set1_epi8(0x7f)));
+				return _mm_or_si128(is_print_or_sp, _mm_cmpeq_epi8(chars, _mm_set1_epi8('\t')));
+			}
+
+			__attribute__((target("avx2")))
+			static __m256i is_member_avx2(__m256i chars) noexcept {
+				__m256i is_print_or_sp = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(0x1f)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x7f), chars));
+				return _mm256_or_si256(is_print_or_sp, _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\t')));
+			}
+#endif
+		};
+
+
+		// --------------------------------------------------------------
+
+
+		template <typename Class>
+		inline const char* _find_scalar(const char* begin, const char* end) noexcept {
+			while (begin < end && Class::is_member(*begin)) {
+				begin++;
+			}
+
+			return begin;
+		}
+
+
+#if defined(__x86_64__)
+		template <typename Class>
+		inline const char* _find_sse2(const char* begin, const char* end) noexcept {
+			for (; end - begin >= 16; begin += 16) {
+				__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+				unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(Class::is_member_sse2(chars))) & 0xffffu;
+
+				if (mask != 0) {
+					return begin + __builtin_ctz(mask);
+				}
+			}
+
+			return _find_scalar<Class>(begin, end);
+		}
+
+
+		template <typename Class>
+		__attribute__((target("avx2")))
+		inline const char* _find_avx2(const char* begin, const char* end) noexcept {
+			for (; end - begin >= 32; begin += 32) {
+				__m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+				unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(Class::is_member_avx2(chars)));
+
+				if (mask != 0) {
+					return begin + __builtin_ctz(mask);
+				}
+			}
+
+			// The tail is shorter than 32 chars.
+			return _find_sse2<Class>(begin, end);
+		}
+#endif
+
+
+		// --------------------------------------------------------------
+
+
+		using _find_t = const char* (*)(const char* begin, const char* end) noexcept;
+
+		struct _dispatch {
+			kernel_t	kernel;
+			_find_t		find_non_token;
+			_find_t		find_non_print;
+			_find_t		find_non_print_or_space;
+		};
+
+
+		inline _dispatch _make_dispatch(kernel_t kernel) noexcept {
+#if defined(__x86_64__)
+			if (kernel == kernel::avx2) {
+				return _dispatch { kernel, _find_avx2<_token_class>, _find_avx2<_print_class>, _find_avx2<_print_or_space_class> };
+			}
+
+			if (kernel == kernel::sse2) {
+				return _dispatch { kernel, _find_sse2<_token_class>, _find_sse2<_print_class>, _find_sse2<_print_or_space_class> };
+			}
+#endif
+
+			return _dispatch { kernel::scalar, _find_scalar<_token_class>, _find_scalar<_print_class>, _find_scalar<_print_or_space_class> };
+		}
+
+
+		inline _dispatch& _active_dispatch() noexcept {
+			static _dispatch dispatch = _make_dispatch(supported_kernel());
+			return dispatch;
+		}
+
+
+		// --------------------------------------------------------------
+
+
+		inline const char* find_non_token(const char* begin, const char* end) noexcept {
+			return _active_dispatch().find_non_token(begin, end);
+		}
+
+
+		inline const char* find_non_print(const char* begin, const char* end) noexcept {
+			return _active_dispatch().find_non_print(begin, end);
+		}
+
+
+		inline const char* find_non_print_or_space(const char* begin, const char* end) noexcept {
+			return _active_dispatch().find_non_print_or_space(begin, end);
+		}
+
+
+		inline kernel_t supported_kernel() noexcept {
+#if defined(__x86_64__)
+			// SSE2 is part of x86-64.
+			static const kernel_t supported = __builtin_cpu_supports("avx2") ? kernel::avx2 : kernel::sse2;
+			return supported;
+#else
+			return kernel::scalar;
+#endif
+		}
+
+
+		inline kernel_t active_kernel() noexcept {
+			return _active_dispatch().kernel;
+		}
+
+
+		inline void set_kernel(kernel_t kernel) noexcept {
+			if (kernel <= supported_kernel()) {
+				_active_dispatch() = _make_dispatch(kernel);
+			}
+		}
+
+	}
+
+}
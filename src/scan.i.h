@@ -0,0 +1,69 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstdint>
+
+
+namespace abc {
+
+	// Kernels that find the first char that doesn't belong to a char class, scanning 16 (SSE2) or 32 (AVX2) chars at a time.
+	// The widest kernel the CPU supports is picked at runtime. The scalar kernel is the fallback on other CPUs.
+	namespace scan {
+
+		using kernel_t = std::uint8_t;
+
+		namespace kernel {
+			constexpr kernel_t	scalar	= 0;
+			constexpr kernel_t	sse2	= 1;
+			constexpr kernel_t	avx2	= 2;
+		}
+
+
+		// Returns the first char in [begin, end) that is not an http token char (ascii::http::is_token), or end.
+		const char*	find_non_token(const char* begin, const char* end) noexcept;
+
+		// Returns the first char in [begin, end) that is not printable (ascii::is_abcprint), or end.
+		const char*	find_non_print(const char* begin, const char* end) noexcept;
+
+		// Returns the first char in [begin, end) that is neither printable nor a space (ascii::is_abcprint_or_space), or end.
+		const char*	find_non_print_or_space(const char* begin, const char* end) noexcept;
+
+
+		// The widest kernel the CPU supports.
+		kernel_t	supported_kernel() noexcept;
+
+		// The kernel in use.
+		kernel_t	active_kernel() noexcept;
+
+		// Switches to a narrower kernel, e.g. for testing and benchmarking. A kernel the CPU doesn't support is ignored.
+		// This is not thread-safe. It should be called before any scanning starts.
+		void		set_kernel(kernel_t kernel) noexcept;
+
+	}
+
+}
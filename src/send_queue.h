@@ -0,0 +1,256 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstring>
+#include <algorithm>
+
+#include "send_queue.i.h"
+#include "socket.h"
+#include "reactor.h"
+
+
+namespace abc {
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline send_queue<Socket, Size, Reactor, Log>::send_queue(Socket* socket, Reactor* reactor, Log* log)
+		: base()
+		, _socket(socket)
+		, _reactor(reactor)
+		, _handler(nullptr)
+		, _log(log)
+		, _sent_size(0)
+		, _status(socket::status::done)
+		, _is_armed(false) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::socket, severity::abc::debug, 0x10450, "send_queue::send_queue() size=%zu", Size);
+		}
+
+		if (socket == nullptr) {
+			throw exception<std::logic_error, Log>("send_queue::send_queue() socket", 0x10451, _log);
+		}
+
+		if (reactor == nullptr) {
+			throw exception<std::logic_error, Log>("send_queue::send_queue() reactor", 0x10452, _log);
+		}
+
+		base::setp(_buffer, _buffer + Size);
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline send_queue<Socket, Size, Reactor, Log>::~send_queue() noexcept {
+		try {
+			disarm();
+		}
+		catch (...) {
+		}
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline void send_queue<Socket, Size, Reactor, Log>::set_handler(send_queue_handler* handler) noexcept {
+		_handler = handler;
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline std::size_t send_queue<Socket, Size, Reactor, Log>::queued_size() const noexcept {
+		return (base::pptr() - base::pbase()) - _sent_size;
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline std::size_t send_queue<Socket, Size, Reactor, Log>::free_size() const noexcept {
+		return Size - queued_size();
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline bool send_queue<Socket, Size, Reactor, Log>::is_backpressured() const noexcept {
+		return queued_size() >= high_watermark;
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline socket::status_t send_queue<Socket, Size, Reactor, Log>::status() const noexcept {
+		return _status;
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline void send_queue<Socket, Size, Reactor, Log>::on_event(event_t events) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::socket, severity::abc::debug, 0x10453, "send_queue::on_event() events=%x, queued_size=%zu", events, queued_size());
+		}
+
+		// A oneshot registration is disabled once it fires.
+		if (_is_armed && queued_size() > 0) {
+			send_queued();
+		}
+
+		if (_handler != nullptr && (_status == socket::status::closed || queued_size() <= low_watermark)) {
+			// The handler may write more, which re-arms the queue as needed.
+			_handler->on_send_ready();
+		}
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline typename send_queue<Socket, Size, Reactor, Log>::int_type send_queue<Socket, Size, Reactor, Log>::overflow(int_type ch) {
+		if (traits_type::eq_int_type(ch, traits_type::eof())) {
+			return traits_type::not_eof(ch);
+		}
+
+		char chr = traits_type::to_char_type(ch);
+		return xsputn(&chr, 1) == 1 ? ch : traits_type::eof();
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline std::streamsize send_queue<Socket, Size, Reactor, Log>::xsputn(const char* s, std::streamsize count) {
+		std::size_t size = static_cast<std::size_t>(count);
+		std::size_t written_size = 0;
+
+		// With nothing queued, a large write goes straight to the socket, and only what the socket doesn't take gets copied.
+		bool is_blocked = false;
+		if (_status == socket::status::done && queued_size() == 0 && size >= Size) {
+			socket::status_t status = _socket->try_send(s, size, written_size);
+
+			if (status == socket::status::closed) {
+				_status = socket::status::closed;
+			}
+
+			is_blocked = status == socket::status::would_block;
+		}
+
+		while (written_size < size && _status == socket::status::done) {
+			if (base::pptr() == base::epptr()) {
+				compact();
+			}
+
+			// Make room by sending what's queued.
+			if (base::pptr() == base::epptr()) {
+				send_queued();
+				compact();
+
+				if (base::pptr() == base::epptr()) {
+					break;
+				}
+			}
+
+			std::size_t copy_size = std::min(size - written_size, static_cast<std::size_t>(base::epptr() - base::pptr()));
+			std::memmove(base::pptr(), s + written_size, copy_size);
+			base::pbump(static_cast<int>(copy_size));
+			written_size += copy_size;
+		}
+
+		// The socket has already refused bytes, so the rest have to wait for it to become writable.
+		if (is_blocked && queued_size() > 0) {
+			arm();
+		}
+
+		if (written_size < size && _log != nullptr) {
+			_log->put_any(category::abc::socket, severity::abc::optional, 0x10454, "send_queue::xsputn() Short write. size=%zu, written_size=%zu, status=%u", size, written_size, _status);
+		}
+
+		return static_cast<std::streamsize>(written_size);
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline int send_queue<Socket, Size, Reactor, Log>::sync() {
+		if (_status == socket::status::done && queued_size() > 0) {
+			send_queued();
+		}
+
+		return _status == socket::status::closed ? -1 : 0;
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline void send_queue<Socket, Size, Reactor, Log>::send_queued() {
+		std::size_t sent_size;
+		socket::status_t status = _socket->try_send(base::pbase() + _sent_size, queued_size(), sent_size);
+		_sent_size += sent_size;
+
+		if (status == socket::status::closed) {
+			if (_log != nullptr) {
+				_log->put_any(category::abc::socket, severity::abc::optional, 0x10455, "send_queue::send_queued() Closed. dropped_size=%zu", queued_size());
+			}
+
+			_status = socket::status::closed;
+			_sent_size = 0;
+			base::setp(_buffer, _buffer + Size);
+			disarm();
+		}
+		else if (queued_size() == 0) {
+			_sent_size = 0;
+			base::setp(_buffer, _buffer + Size);
+			disarm();
+		}
+		else {
+			arm();
+		}
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline void send_queue<Socket, Size, Reactor, Log>::compact() noexcept {
+		if (_sent_size == 0) {
+			return;
+		}
+
+		std::size_t size = queued_size();
+		std::memmove(_buffer, _buffer + _sent_size, size);
+		_sent_size = 0;
+		base::setp(_buffer, _buffer + Size);
+		base::pbump(static_cast<int>(size));
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline void send_queue<Socket, Size, Reactor, Log>::arm() {
+		if (_is_armed) {
+			_reactor->modify(_socket->handle(), event::writable | event::oneshot, this);
+		}
+		else {
+			_reactor->add(_socket->handle(), event::writable | event::oneshot, this);
+			_is_armed = true;
+		}
+	}
+
+
+	template <typename Socket, std::size_t Size, typename Reactor, typename Log>
+	inline void send_queue<Socket, Size, Reactor, Log>::disarm() {
+		if (_is_armed) {
+			_is_armed = false;
+			_reactor->remove(_socket->handle());
+		}
+	}
+
+}
@@ -0,0 +1,118 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <streambuf>
+
+#include "size.h"
+#include "socket.i.h"
+#include "reactor.i.h"
+#include "log.i.h"
+
+
+namespace abc {
+
+	// A producer that writes into a send_queue gets notified when the queue has drained enough to take more bytes,
+	// or when the connection has been closed.
+	class send_queue_handler {
+	public:
+		virtual ~send_queue_handler() noexcept = default;
+
+		virtual void on_send_ready() = 0;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	// A bounded, fixed-size queue of outgoing bytes in front of a non-blocking client socket.
+	// Writes smaller than Size are buffered until the buffer fills up or sync() is called. Writes of at least Size bytes go
+	// straight to the socket when nothing is queued. Whatever the socket doesn't take is kept in the queue,
+	// and the queue waits for the socket to become writable through the reactor, without blocking the thread.
+	// The queue is a std::streambuf, so that an _http_ostream or a json_ostream can write into it.
+	// Writes never block. A write that doesn't fit is cut short, and the stream goes bad. To avoid that, a producer should
+	// stop writing while is_backpressured() is true, and resume from on_send_ready().
+	// While bytes are queued, the socket's handle is registered with the reactor, so nothing else may register it.
+	// The queue is not thread-safe. It should be used from the reactor's thread.
+	template <typename Socket, std::size_t Size = size::k16, typename Reactor = reactor<>, typename Log = null_log>
+	class send_queue : public std::streambuf, public reactor_handler {
+		using base = std::streambuf;
+
+		static_assert(Size > 0, "Size must be positive.");
+
+	public:
+		// A producer should stop writing once this many bytes are queued...
+		static constexpr std::size_t high_watermark = Size / 2;
+
+		// ...and it gets notified once the queue has drained to this many bytes.
+		static constexpr std::size_t low_watermark = Size / 4;
+
+	public:
+		send_queue(Socket* socket, Reactor* reactor, Log* log = nullptr);
+		send_queue(send_queue&& other) = delete;
+		send_queue(const send_queue& other) = delete;
+
+		~send_queue() noexcept;
+
+	public:
+		void				set_handler(send_queue_handler* handler) noexcept;
+
+		std::size_t			queued_size() const noexcept;
+		std::size_t			free_size() const noexcept;
+		bool				is_backpressured() const noexcept;
+
+		// done while the connection is usable, or closed once the peer has gone away. Queued bytes are dropped then.
+		socket::status_t	status() const noexcept;
+
+	public:
+		virtual void		on_event(event_t events) override;
+
+	protected:
+		virtual int_type		overflow(int_type ch) override;
+		virtual std::streamsize	xsputn(const char* s, std::streamsize count) override;
+		virtual int				sync() override;
+
+	private:
+		void				send_queued();
+		void				compact() noexcept;
+		void				arm();
+		void				disarm();
+
+	private:
+		Socket*				_socket;
+		Reactor*			_reactor;
+		send_queue_handler*	_handler;
+		Log*				_log;
+
+		std::size_t			_sent_size;
+		socket::status_t	_status;
+		bool				_is_armed;
+		char				_buffer[Size];
+	};
+
+}
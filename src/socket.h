@@ -27,14 +27,167 @@ SOFTWARE.
 
 #include <stdexcept>
 #include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <arpa/inet.h>
 
 #include "socket.i.h"
+#include "ring_buffer.h"
 #include "exception.h"
 #include "tag.h"
 
 
 namespace abc {
 
+	template <std::size_t Size>
+	inline address_cache<Size>::address_cache(std::chrono::milliseconds ttl)
+		: _ttl(ttl)
+		, _hit_count(0)
+		, _miss_count(0) {
+		clear();
+	}
+
+
+	template <std::size_t Size>
+	inline bool address_cache<Size>::lookup(const char* host, const char* port, socket::kind_t kind, socket::family_t family, sockaddr_storage& addr, socklen_t& addr_size) {
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		entry* e = find(host, port, kind, family);
+		if (e == nullptr || e->expires_at <= socket::clock::now()) {
+			_miss_count++;
+			return false;
+		}
+
+		std::memcpy(&addr, &e->addr, e->addr_size);
+		addr_size = e->addr_size;
+
+		_hit_count++;
+		return true;
+	}
+
+
+	template <std::size_t Size>
+	inline void address_cache<Size>::put(const char* host, const char* port, socket::kind_t kind, socket::family_t family, const sockaddr& addr, socklen_t addr_size) {
+		// Names that don't fit are simply not cached.
+		if (host == nullptr || port == nullptr || std::strlen(host) >= sizeof(entry::host) || std::strlen(port) >= sizeof(entry::port) || addr_size > sizeof(sockaddr_storage)) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		entry* e = find(host, port, kind, family);
+		if (e == nullptr) {
+			e = &_entries[0];
+			for (entry& candidate : _entries) {
+				if (candidate.expires_at < e->expires_at) {
+					e = &candidate;
+				}
+			}
+
+			std::strcpy(e->host, host);
+			std::strcpy(e->port, port);
+			e->kind = kind;
+			e->family = family;
+		}
+
+		std::memcpy(&e->addr, &addr, addr_size);
+		e->addr_size = addr_size;
+		e->expires_at = socket::clock::now() + _ttl;
+	}
+
+
+	template <std::size_t Size>
+	inline void address_cache<Size>::remove(const char* host, const char* port, socket::kind_t kind, socket::family_t family) {
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		entry* e = find(host, port, kind, family);
+		if (e != nullptr) {
+			e->host[0] = '\0';
+			e->expires_at = socket::clock::time_point::min();
+		}
+	}
+
+
+	template <std::size_t Size>
+	inline void address_cache<Size>::clear() {
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		for (entry& e : _entries) {
+			e.host[0] = '\0';
+			e.port[0] = '\0';
+			e.expires_at = socket::clock::time_point::min();
+		}
+	}
+
+
+	template <std::size_t Size>
+	inline std::size_t address_cache<Size>::hit_count() const noexcept {
+		return _hit_count;
+	}
+
+
+	template <std::size_t Size>
+	inline std::size_t address_cache<Size>::miss_count() const noexcept {
+		return _miss_count;
+	}
+
+
+	template <std::size_t Size>
+	inline typename address_cache<Size>::entry* address_cache<Size>::find(const char* host, const char* port, socket::kind_t kind, socket::family_t family) noexcept {
+		if (host == nullptr || port == nullptr) {
+			return nullptr;
+		}
+
+		for (entry& e : _entries) {
+			if (e.kind == kind && e.family == family && std::strcmp(e.host, host) == 0 && std::strcmp(e.port, port) == 0) {
+				return &e;
+			}
+		}
+
+		return nullptr;
+	}
+
+
+	inline address_cache<>& socket::default_address_cache() {
+		static address_cache<> cache;
+
+		return cache;
+	}
+
+
+	inline socket::address socket::local_address(const char* path) noexcept {
+		socket::address address;
+		sockaddr_un& addr = reinterpret_cast<sockaddr_un&>(address.storage);
+		std::size_t path_len = std::strlen(path);
+
+		if (path_len >= sizeof(addr.sun_path)) {
+			address.size = 0;
+			return address;
+		}
+
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		std::memcpy(addr.sun_path, path, path_len);
+
+		if (path[0] == '@') {
+			// An abstract name starts with '\0', and it is not '\0'-terminated.
+			addr.sun_path[0] = '\0';
+			address.size = offsetof(sockaddr_un, sun_path) + path_len;
+		}
+		else {
+			address.size = offsetof(sockaddr_un, sun_path) + path_len + 1;
+		}
+
+		return address;
+	}
+
+
+	// --------------------------------------------------------------
+
+
 	template <typename Log>
 	inline _basic_socket<Log>::_basic_socket(socket::kind_t kind, socket::family_t family, Log* log)
 		: _basic_socket(socket::handle::invalid, kind, family, log) {
@@ -46,13 +199,15 @@ namespace abc {
 		: _handle(handle)
 		, _kind(kind)
 		, _family(family)
-		, _protocol(kind == socket::kind::stream ? socket::protocol::tcp : socket::protocol::udp)
+		, _protocol(family == socket::family::local ? socket::protocol::local : kind == socket::kind::stream ? socket::protocol::tcp : socket::protocol::udp)
+		, _is_reuse_port(false)
+		, _stats(nullptr)
 		, _log(log) {
 		if (kind != socket::kind::stream && kind != socket::kind::dgram) {
 			throw exception<std::logic_error, Log>("kind", 0x10004, log);
 		}
 
-		if (family != socket::family::ipv4 && family != socket::family::ipv6) {
+		if (family != socket::family::ipv4 && family != socket::family::ipv6 && family != socket::family::local) {
 			throw exception<std::logic_error, Log>("family", 0x10005, log);
 		}
 
@@ -68,6 +223,8 @@ namespace abc {
 		_family = other._family;
 		_protocol = other._protocol;
 		_handle = other._handle;
+		_is_reuse_port = other._is_reuse_port;
+		_stats = other._stats;
 		_log = std::move(other._log);
 
 		other._handle = socket::handle::invalid;
@@ -123,6 +280,15 @@ namespace abc {
 			throw exception<std::runtime_error, Log>("::socket()", 0x1000b, _log);
 		}
 
+		if (_is_reuse_port) {
+			int value = 1;
+			if (::setsockopt(_handle, SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value)) < 0) {
+				close();
+
+				throw exception<std::runtime_error, Log>("::setsockopt(SO_REUSEPORT)", 0x103b9, _log);
+			}
+		}
+
 		if (_log != nullptr) {
 			_log->put_any(category::abc::socket, severity::abc::debug, 0x1000c, "_basic_socket::open() done");
 		}
@@ -154,12 +320,58 @@ namespace abc {
 	}
 
 
+	template <typename Log>
+	inline void _basic_socket<Log>::bind(const socket::address& address) {
+		tie(address, socket::tie::bind);
+	}
+
+
+	template <typename Log>
+	inline void _basic_socket<Log>::set_blocking(bool is_blocking) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::socket, severity::abc::debug, 0x1034b, "_basic_socket::set_blocking() is_blocking=%d", is_blocking);
+		}
+
+		if (!is_open()) {
+			open();
+		}
+
+		int flags = ::fcntl(_handle, F_GETFL, 0);
+		if (flags < 0) {
+			throw exception<std::runtime_error, Log>("::fcntl(F_GETFL)", 0x1034c, _log);
+		}
+
+		flags = is_blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+
+		if (::fcntl(_handle, F_SETFL, flags) < 0) {
+			throw exception<std::runtime_error, Log>("::fcntl(F_SETFL)", 0x1034d, _log);
+		}
+	}
+
+
+	template <typename Log>
+	inline void _basic_socket<Log>::set_reuse_port(bool is_reuse_port) noexcept {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::socket, severity::abc::debug, 0x103ba, "_basic_socket::set_reuse_port() is_reuse_port=%d", is_reuse_port);
+		}
+
+		_is_reuse_port = is_reuse_port;
+	}
+
+
 	template <typename Log>
 	inline void _basic_socket<Log>::tie(const char* host, const char* port, socket::tie_t tt) {
 		if (_log != nullptr) {
 			_log->put_any(category::abc::socket, severity::abc::debug, 0x1000d, "_basic_socket::tie() >>> %s", tt == socket::tie::bind ? "bind" : "connect");
 		}
 
+		// Local sockets are addressed by path. There is no host, and nothing to resolve.
+		if (_family == socket::family::local) {
+			socket::address address = socket::local_address(port);
+			tie(address, tt);
+			return;
+		}
+
 		if (!is_open()) {
 			open();
 		}
@@ -167,6 +379,24 @@ namespace abc {
 			throw exception<std::runtime_error, Log>("is_open()", 0x1000e, _log);
 		}
 
+		// Try the address that worked last time before going to the resolver.
+		if (tt == socket::tie::connect) {
+			sockaddr_storage cached_addr;
+			socklen_t cached_addr_size;
+
+			if (socket::default_address_cache().lookup(host, port, _kind, _family, cached_addr, cached_addr_size)) {
+				if (tie(reinterpret_cast<const sockaddr&>(cached_addr), cached_addr_size, tt) == socket::error::none) {
+					if (_log != nullptr) {
+						_log->put_any(category::abc::socket, severity::abc::optional, 0x103df, "_basic_socket::tie() <<< connect (cached)");
+					}
+
+					return;
+				}
+
+				socket::default_address_cache().remove(host, port, _kind, _family);
+			}
+		}
+
 		addrinfo hnt = hints();
 		addrinfo* hostList = nullptr;
 
@@ -181,10 +411,14 @@ namespace abc {
 		}
 
 		bool is_done = false;
-		for (addrinfo* host = hostList; host != nullptr; host = host->ai_next) {
-			err = tie(*(host->ai_addr), host->ai_addrlen, tt);
+		for (addrinfo* host_local = hostList; host_local != nullptr; host_local = host_local->ai_next) {
+			err = tie(*(host_local->ai_addr), host_local->ai_addrlen, tt);
 
 			if (err == socket::error::none) {
+				if (tt == socket::tie::connect) {
+					socket::default_address_cache().put(host, port, _kind, _family, *(host_local->ai_addr), host_local->ai_addrlen);
+				}
+
 				is_done = true;
 				break;
 			}
@@ -283,12 +517,97 @@ namespace abc {
 	}
 
 
+	template <typename Log>
+	inline void _basic_socket<Log>::set_stats(socket_stats* stats) noexcept {
+		_stats = stats;
+	}
+
+
+	template <typename Log>
+	inline socket_stats* _basic_socket<Log>::stats() const noexcept {
+		return _stats;
+	}
+
+
 	template <typename Log>
 	inline Log* _basic_socket<Log>::log() const noexcept {
 		return _log;
 	}
 
 
+	template <typename Log>
+	inline socket::clock::time_point _basic_socket<Log>::stats_begin() const noexcept {
+		return _stats != nullptr ? socket::clock::now() : socket::clock::time_point();
+	}
+
+
+	template <typename Log>
+	inline void _basic_socket<Log>::stats_end_send(socket::clock::time_point begin, ssize_t sent_size, std::size_t size) noexcept {
+		if (_stats == nullptr) {
+			return;
+		}
+
+		// Read errno before anything else could change it.
+		int err = errno;
+
+		_stats->send_calls.fetch_add(1, std::memory_order_relaxed);
+
+		if (sent_size >= 0) {
+			_stats->bytes_sent.fetch_add(sent_size, std::memory_order_relaxed);
+
+			if (static_cast<std::size_t>(sent_size) < size) {
+				_stats->partial_sends.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+		else if (err == EAGAIN || err == EWOULDBLOCK) {
+			_stats->would_block_count.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		_stats->blocked_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(socket::clock::now() - begin).count(), std::memory_order_relaxed);
+
+		errno = err;
+	}
+
+
+	template <typename Log>
+	inline void _basic_socket<Log>::stats_end_receive(socket::clock::time_point begin, ssize_t received_size) noexcept {
+		if (_stats == nullptr) {
+			return;
+		}
+
+		// Read errno before anything else could change it.
+		int err = errno;
+
+		_stats->receive_calls.fetch_add(1, std::memory_order_relaxed);
+
+		if (received_size >= 0) {
+			_stats->bytes_received.fetch_add(received_size, std::memory_order_relaxed);
+		}
+		else if (err == EAGAIN || err == EWOULDBLOCK) {
+			_stats->would_block_count.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		_stats->blocked_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(socket::clock::now() - begin).count(), std::memory_order_relaxed);
+
+		errno = err;
+	}
+
+
+	template <typename Log>
+	inline void _basic_socket<Log>::stats_end_wait(socket::clock::time_point begin) noexcept {
+		if (_stats == nullptr) {
+			return;
+		}
+
+		int err = errno;
+
+		_stats->wait_calls.fetch_add(1, std::memory_order_relaxed);
+		_stats->blocked_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(socket::clock::now() - begin).count(), std::memory_order_relaxed);
+
+		errno = err;
+	}
+
+
 	// --------------------------------------------------------------
 
 
@@ -333,16 +652,40 @@ namespace abc {
 				throw exception<std::logic_error, Log>("!dgram", 0x10018, log_local);
 			}
 
+			socket::clock::time_point begin = base::stats_begin();
 			sent_size = ::sendto(base::handle(), buffer, size, 0, &address->value, address->size);
+			base::stats_end_send(begin, sent_size, size);
+		}
+		else if (base::kind() == socket::kind::stream) {
+			// A stream socket may accept fewer bytes than requested. Keep sending until everything is sent.
+			const char* chars = static_cast<const char*>(buffer);
+			std::size_t total_size = 0;
+
+			do {
+				socket::clock::time_point begin = base::stats_begin();
+				sent_size = ::send(base::handle(), chars + total_size, size - total_size, MSG_NOSIGNAL);
+				base::stats_end_send(begin, sent_size, size - total_size);
+
+				if (sent_size > 0) {
+					total_size += sent_size;
+				}
+			}
+			while (total_size < size && (sent_size > 0 || (sent_size < 0 && errno == EINTR)));
+
+			if (sent_size >= 0) {
+				sent_size = total_size;
+			}
 		}
 		else {
+			socket::clock::time_point begin = base::stats_begin();
 			sent_size = ::send(base::handle(), buffer, size, 0);
+			base::stats_end_send(begin, sent_size, size);
 		}
 
 		if (sent_size < 0) {
 			throw exception<std::runtime_error, Log>("::send()", 0x10019, log_local);
 		}
-		else if (sent_size < size) {
+		else if (static_cast<std::size_t>(sent_size) < size) {
 			throw exception<std::runtime_error, Log>("::send()", 0x1001a, log_local);
 		}
 
@@ -370,16 +713,40 @@ namespace abc {
 				throw exception<std::logic_error, Log>("!dgram", 0x1001e, log_local);
 			}
 
-			 received_size = ::recvfrom(base::handle(), buffer, size, 0, &address->value, &address->size);
+			socket::clock::time_point begin = base::stats_begin();
+			received_size = ::recvfrom(base::handle(), buffer, size, 0, &address->value, &address->size);
+			base::stats_end_receive(begin, received_size);
+		}
+		else if (base::kind() == socket::kind::stream) {
+			// A stream socket may return fewer bytes than requested. Keep receiving until the buffer is full or the peer closes.
+			char* chars = static_cast<char*>(buffer);
+			std::size_t total_size = 0;
+
+			do {
+				socket::clock::time_point begin = base::stats_begin();
+				received_size = ::recv(base::handle(), chars + total_size, size - total_size, 0);
+				base::stats_end_receive(begin, received_size);
+
+				if (received_size > 0) {
+					total_size += received_size;
+				}
+			}
+			while (total_size < size && (received_size > 0 || (received_size < 0 && errno == EINTR)));
+
+			if (received_size >= 0) {
+				received_size = total_size;
+			}
 		}
 		else {
-			 received_size = ::recv(base::handle(), buffer, size, 0);
+			socket::clock::time_point begin = base::stats_begin();
+			received_size = ::recv(base::handle(), buffer, size, 0);
+			base::stats_end_receive(begin, received_size);
 		}
 
 		if (received_size < 0) {
 			throw exception<std::runtime_error, Log>("::recv()", 0x1001f, log_local);
 		}
-		else if (received_size < size) {
+		else if (static_cast<std::size_t>(received_size) < size) {
 			throw exception<std::runtime_error, Log>("::recv()", 0x10020, log_local);
 		}
 
@@ -390,144 +757,1351 @@ namespace abc {
 	}
 
 
-	// --------------------------------------------------------------
-
-
-	template <typename Log>
-	inline udp_socket<Log>::udp_socket(Log* log)
-		: udp_socket<Log>(socket::family::ipv4, log) {
-	}
-
-
 	template <typename Log>
-	inline udp_socket<Log>::udp_socket(socket::family_t family, Log* log)
-		: _client_socket<Log>(socket::kind::dgram, family, log) {
-	}
-
+	inline std::size_t _client_socket<Log>::receive_some(void* buffer, std::size_t size) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10340, "_client_socket::receive_some() >>> size=%lu", (std::uint32_t)size);
+		}
 
-	// --------------------------------------------------------------
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x10341, log_local);
+		}
 
+		ssize_t received_size;
+		do {
+			socket::clock::time_point begin = base::stats_begin();
+			received_size = ::recv(base::handle(), buffer, size, 0);
+			base::stats_end_receive(begin, received_size);
+		}
+		while (received_size < 0 && errno == EINTR);
 
-	template <typename Log>
-	inline tcp_client_socket<Log>::tcp_client_socket(Log* log)
-		: tcp_client_socket<Log>(socket::family::ipv4, log) {
-	}
+		if (received_size < 0) {
+			throw exception<std::runtime_error, Log>("::recv()", 0x10342, log_local);
+		}
 
+		if (log_local != nullptr) {
+			log_local->put_binary(category::abc::socket, severity::abc::optional, 0x10343, buffer, received_size);
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x10344, "_client_socket::receive_some() <<< size=%lu", (std::uint32_t)received_size);
+		}
 
-	template <typename Log>
-	inline tcp_client_socket<Log>::tcp_client_socket(socket::family_t family, Log* log)
-		: _client_socket<Log>(socket::kind::stream, family, log) {
+		return received_size;
 	}
 
 
 	template <typename Log>
-	inline tcp_client_socket<Log>::tcp_client_socket(socket::handle_t handle, socket::family_t family, Log* log)
-		: _client_socket<Log>(handle, socket::kind::stream, family, log) {
-	}
+	inline void _client_socket<Log>::send(const iovec* vector, std::size_t count) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10381, "_client_socket::send(iovec) >>> count=%lu", (std::uint32_t)count);
+		}
 
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x10382, log_local);
+		}
 
-	// --------------------------------------------------------------
+		while (count > 0) {
+			std::size_t count_local = std::min(count, static_cast<std::size_t>(IOV_MAX));
 
+			std::size_t size = 0;
+			for (std::size_t i = 0; i < count_local; i++) {
+				size += vector[i].iov_len;
+			}
 
-	template <typename Log>
-	inline tcp_server_socket<Log>::tcp_server_socket(Log* log)
-		: tcp_server_socket<Log>(socket::family::ipv4, log) {
-	}
+			msghdr message = { 0 };
+			message.msg_iov = const_cast<iovec*>(vector);
+			message.msg_iovlen = count_local;
 
+			ssize_t sent_size;
+			do {
+				socket::clock::time_point begin = base::stats_begin();
+				sent_size = ::sendmsg(base::handle(), &message, MSG_NOSIGNAL);
+				base::stats_end_send(begin, sent_size, size);
+			}
+			while (sent_size < 0 && errno == EINTR);
 
-	template <typename Log>
-	inline tcp_server_socket<Log>::tcp_server_socket(socket::family_t family, Log* log)
-		: _basic_socket<Log>(socket::kind::stream, family, log) {
-	}
+			if (sent_size < 0) {
+				throw exception<std::runtime_error, Log>("::sendmsg()", 0x10383, log_local);
+			}
 
+			if (static_cast<std::size_t>(sent_size) < size) {
+				if (base::kind() != socket::kind::stream) {
+					throw exception<std::runtime_error, Log>("::sendmsg()", 0x10384, log_local);
+				}
 
-	template <typename Log>
-	inline void tcp_server_socket<Log>::listen(socket::backlog_size_t backlog_size) {
-		Log* log_local = base::log();
-		if (log_local != nullptr) {
-			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10022, "tcp_server_socket::listen() >>>");
-		}
+				// Skip the elements that were sent entirely, and finish the element that was sent partially.
+				// The caller's vector is const, so it is not adjusted.
+				std::size_t i = 0;
+				while (static_cast<std::size_t>(sent_size) >= vector[i].iov_len) {
+					sent_size -= vector[i++].iov_len;
+				}
 
-		socket::error_t err = ::listen(base::handle(), backlog_size);
+				send(static_cast<const char*>(vector[i].iov_base) + sent_size, vector[i].iov_len - sent_size);
+				count_local = i + 1;
+			}
 
-		if (err != socket::error::none) {
-			throw exception<std::runtime_error, Log>("::listen()", 0x10023, log_local);
+			vector += count_local;
+			count -= count_local;
 		}
 
 		if (log_local != nullptr) {
-			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10024, "tcp_server_socket::listen() <<<");
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x10385, "_client_socket::send(iovec) <<<");
 		}
 	}
 
 
 	template <typename Log>
-	inline tcp_client_socket<Log> tcp_server_socket<Log>::accept() const {
+	inline void _client_socket<Log>::receive(iovec* vector, std::size_t count) {
 		Log* log_local = base::log();
 		if (log_local != nullptr) {
-			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10025, "tcp_server_socket::accept() >>>");
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10386, "_client_socket::receive(iovec) >>> count=%lu", (std::uint32_t)count);
 		}
 
-		socket::handle_t hnd = ::accept(base::handle(), nullptr, nullptr);
-
-		if (hnd == socket::handle::invalid) {
-			throw exception<std::runtime_error, Log>("::accept()", 0x10026, log_local);
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x10387, log_local);
 		}
 
-		if (log_local != nullptr) {
-			log_local->put_any(category::abc::socket, severity::abc::optional, 0x10027, "tcp_server_socket::accept() <<<");
-		}
+		while (count > 0) {
+			std::size_t count_local = std::min(count, static_cast<std::size_t>(IOV_MAX));
 
-		return tcp_client_socket<Log>(hnd, base::family(), base::log());
-	}
+			std::size_t size = 0;
+			for (std::size_t i = 0; i < count_local; i++) {
+				size += vector[i].iov_len;
+			}
 
+			msghdr message = { 0 };
+			message.msg_iov = vector;
+			message.msg_iovlen = count_local;
 
-	// --------------------------------------------------------------
+			ssize_t received_size;
+			do {
+				socket::clock::time_point begin = base::stats_begin();
+				received_size = ::recvmsg(base::handle(), &message, 0);
+				base::stats_end_receive(begin, received_size);
+			}
+			while (received_size < 0 && errno == EINTR);
 
+			if (received_size < 0) {
+				throw exception<std::runtime_error, Log>("::recvmsg()", 0x10388, log_local);
+			}
 
-	template <typename Socket, typename Log>
-	inline socket_streambuf<Socket, Log>::socket_streambuf(Socket* socket, Log* log)
-		: std::streambuf()
-		, _socket(socket)
-		, _log(log) {
-		if (socket == nullptr) {
-			throw exception<std::logic_error, Log>("socket", 0x10068, _log);
+			if (static_cast<std::size_t>(received_size) < size) {
+				if (base::kind() != socket::kind::stream || received_size == 0) {
+					throw exception<std::runtime_error, Log>("::recvmsg()", 0x10389, log_local);
+				}
+
+				// Skip the elements that were filled entirely, and finish the element that was filled partially.
+				// The caller's vector is not adjusted.
+				std::size_t i = 0;
+				while (static_cast<std::size_t>(received_size) >= vector[i].iov_len) {
+					received_size -= vector[i++].iov_len;
+				}
+
+				receive(static_cast<char*>(vector[i].iov_base) + received_size, vector[i].iov_len - received_size);
+				count_local = i + 1;
+			}
+
+			vector += count_local;
+			count -= count_local;
 		}
 
-		setg(&_get_ch, &_get_ch, &_get_ch);
-		setp(&_put_ch, &_put_ch + 1);
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x1038a, "_client_socket::receive(iovec) <<<");
+		}
 	}
 
 
-	template <typename Socket, typename Log>
-	inline std::streambuf::int_type socket_streambuf<Socket, Log>::underflow() {
-		_socket->receive(&_get_ch, sizeof(char));
+	template <typename Log>
+	inline void _client_socket<Log>::send_file(int file_handle, off_t offset, std::size_t size) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x103b0, "_client_socket::send_file() >>> offset=%lu, size=%lu", (std::uint32_t)offset, (std::uint32_t)size);
+		}
 
-		setg(&_get_ch, &_get_ch, &_get_ch + 1);
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x103b1, log_local);
+		}
 
-		return _get_ch;
-	}
+		// sendfile() may send fewer bytes than requested. It advances offset by the number of bytes sent.
+		while (size > 0) {
+			socket::clock::time_point begin = base::stats_begin();
+			ssize_t sent_size = ::sendfile(base::handle(), file_handle, &offset, size);
+			base::stats_end_send(begin, sent_size, size);
 
+			if (sent_size < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
 
-	template <typename Socket, typename Log>
-	inline std::streambuf::int_type socket_streambuf<Socket, Log>::overflow(std::streambuf::int_type ch) {
-		_socket->send(&_put_ch, sizeof(char));
-		_socket->send(&ch, sizeof(char));
+				throw exception<std::runtime_error, Log>("::sendfile()", 0x103b2, log_local);
+			}
+			else if (sent_size == 0) {
+				// The file is shorter than expected.
+				throw exception<std::runtime_error, Log>("::sendfile()", 0x103b3, log_local);
+			}
 
-		setp(&_put_ch, &_put_ch + 1);
+			size -= sent_size;
+		}
 
-		return ch;
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x103b4, "_client_socket::send_file() <<< offset=%lu", (std::uint32_t)offset);
+		}
 	}
 
 
-	template <typename Socket, typename Log>
-	inline int socket_streambuf<Socket, Log>::sync() {
-		if (pptr() != &_put_ch) {
-			_socket->send(&_put_ch, sizeof(char));
+	template <typename Log>
+	template <typename Uring>
+	inline bool _client_socket<Log>::prepare_send(Uring& ring, const void* buffer, std::size_t size, std::uint64_t user_data) {
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x104c0, base::log());
 		}
 
-		setp(&_put_ch, &_put_ch + 1);
+		return ring.prepare_send(base::handle(), buffer, size, user_data);
+	}
+
+
+	template <typename Log>
+	template <typename Uring>
+	inline bool _client_socket<Log>::prepare_receive(Uring& ring, void* buffer, std::size_t size, std::uint64_t user_data) {
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x104c1, base::log());
+		}
+
+		return ring.prepare_receive(base::handle(), buffer, size, user_data);
+	}
+
+
+	template <typename Log>
+	inline socket::status_t _client_socket<Log>::try_send(const void* buffer, std::size_t size, std::size_t& sent_size) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x1034e, "_client_socket::try_send() >>> size=%lu", (std::uint32_t)size);
+		}
+
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x1034f, log_local);
+		}
+
+		const char* chars = static_cast<const char*>(buffer);
+		socket::status_t status = socket::status::done;
+		sent_size = 0;
+
+		while (sent_size < size) {
+			socket::clock::time_point begin = base::stats_begin();
+			ssize_t sent_size_local = ::send(base::handle(), chars + sent_size, size - sent_size, MSG_NOSIGNAL | MSG_DONTWAIT);
+			base::stats_end_send(begin, sent_size_local, size - sent_size);
+
+			if (sent_size_local >= 0) {
+				sent_size += sent_size_local;
+			}
+			else if (errno == EINTR) {
+				continue;
+			}
+			else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				status = socket::status::would_block;
+				break;
+			}
+			else if (errno == EPIPE || errno == ECONNRESET) {
+				status = socket::status::closed;
+				break;
+			}
+			else {
+				throw exception<std::runtime_error, Log>("::send()", 0x10350, log_local);
+			}
+		}
+
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x10351, "_client_socket::try_send() <<< status=%u, sent_size=%lu", status, (std::uint32_t)sent_size);
+		}
+
+		return status;
+	}
+
+
+	template <typename Log>
+	inline socket::status_t _client_socket<Log>::try_receive(void* buffer, std::size_t size, std::size_t& received_size) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10352, "_client_socket::try_receive() >>> size=%lu", (std::uint32_t)size);
+		}
+
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x10353, log_local);
+		}
+
+		socket::status_t status = socket::status::done;
+		received_size = 0;
+
+		ssize_t received_size_local;
+		do {
+			socket::clock::time_point begin = base::stats_begin();
+			received_size_local = ::recv(base::handle(), buffer, size, MSG_DONTWAIT);
+			base::stats_end_receive(begin, received_size_local);
+		}
+		while (received_size_local < 0 && errno == EINTR);
+
+		if (received_size_local > 0) {
+			received_size = received_size_local;
+		}
+		else if (received_size_local == 0) {
+			if (size > 0) {
+				status = socket::status::closed;
+			}
+		}
+		else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			status = socket::status::would_block;
+		}
+		else if (errno == ECONNRESET) {
+			status = socket::status::closed;
+		}
+		else {
+			throw exception<std::runtime_error, Log>("::recv()", 0x10354, log_local);
+		}
+
+		if (log_local != nullptr) {
+			if (received_size > 0) {
+				log_local->put_binary(category::abc::socket, severity::abc::optional, 0x10355, buffer, received_size);
+			}
+
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x10356, "_client_socket::try_receive() <<< status=%u, received_size=%lu", status, (std::uint32_t)received_size);
+		}
+
+		return status;
+	}
+
+
+	template <typename Log>
+	inline socket::status_t _client_socket<Log>::connect(const char* host, const char* port, socket::deadline_t deadline) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x103bf, "_client_socket::connect(deadline) >>>");
+		}
+
+		socket::status_t status = socket::status::closed;
+		bool is_local = base::family() == socket::family::local;
+
+		// Try the address that worked last time before going to the resolver.
+		sockaddr_storage cached_addr;
+		socklen_t cached_addr_size;
+
+		if (is_local) {
+			socket::address address = socket::local_address(port);
+			status = try_connect(address.value, address.size, deadline);
+		}
+		else if (socket::default_address_cache().lookup(host, port, base::kind(), base::family(), cached_addr, cached_addr_size)) {
+			status = try_connect(reinterpret_cast<const sockaddr&>(cached_addr), cached_addr_size, deadline);
+
+			if (status == socket::status::closed) {
+				socket::default_address_cache().remove(host, port, base::kind(), base::family());
+			}
+		}
+
+		if (status == socket::status::closed && !is_local) {
+			addrinfo hnt = base::hints();
+			addrinfo* host_list = nullptr;
+
+			if (::getaddrinfo(host, port, &hnt, &host_list) != socket::error::none) {
+				throw exception<std::runtime_error, Log>("::getaddrinfo()", 0x103c0, log_local);
+			}
+
+			for (addrinfo* host_local = host_list; host_local != nullptr && status == socket::status::closed; host_local = host_local->ai_next) {
+				status = try_connect(*(host_local->ai_addr), host_local->ai_addrlen, deadline);
+
+				if (status == socket::status::done) {
+					socket::default_address_cache().put(host, port, base::kind(), base::family(), *(host_local->ai_addr), host_local->ai_addrlen);
+				}
+			}
+
+			::freeaddrinfo(host_list);
+		}
+
+		if (status == socket::status::done) {
+			base::set_blocking(true);
+		}
+		else {
+			base::close();
+
+			if (status != socket::status::timeout) {
+				throw exception<std::runtime_error, Log>("connect()", 0x103c1, log_local);
+			}
+		}
+
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x103c2, "_client_socket::connect(deadline) <<< status=%u", status);
+		}
+
+		return status;
+	}
+
+
+	template <typename Log>
+	inline socket::status_t _client_socket<Log>::send(const void* buffer, std::size_t size, socket::deadline_t deadline) {
+		const char* chars = static_cast<const char*>(buffer);
+		socket::status_t status = socket::status::done;
+		std::size_t total_size = 0;
+
+		while (total_size < size) {
+			std::size_t sent_size;
+			status = try_send(chars + total_size, size - total_size, sent_size);
+			total_size += sent_size;
+
+			if (status == socket::status::would_block) {
+				status = wait(POLLOUT, deadline);
+			}
+
+			if (status != socket::status::done) {
+				break;
+			}
+		}
+
+		return status;
+	}
+
+
+	template <typename Log>
+	inline socket::status_t _client_socket<Log>::receive(void* buffer, std::size_t size, socket::deadline_t deadline) {
+		char* chars = static_cast<char*>(buffer);
+		socket::status_t status = socket::status::done;
+		std::size_t total_size = 0;
+
+		while (total_size < size) {
+			std::size_t received_size;
+			status = try_receive(chars + total_size, size - total_size, received_size);
+			total_size += received_size;
+
+			if (status == socket::status::would_block) {
+				status = wait(POLLIN, deadline);
+			}
+
+			if (status != socket::status::done) {
+				break;
+			}
+		}
+
+		return status;
+	}
+
+
+	template <typename Log>
+	inline void _client_socket<Log>::set_idle_timeout(std::chrono::milliseconds timeout) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x103c3, "_client_socket::set_idle_timeout() timeout=%lld", (long long)timeout.count());
+		}
+
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x103c4, log_local);
+		}
+
+		timeval value;
+		value.tv_sec = timeout.count() / 1000;
+		value.tv_usec = (timeout.count() % 1000) * 1000;
+
+		if (::setsockopt(base::handle(), SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value)) < 0
+			|| ::setsockopt(base::handle(), SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value)) < 0) {
+			throw exception<std::runtime_error, Log>("::setsockopt(SO_RCVTIMEO/SO_SNDTIMEO)", 0x103c5, log_local);
+		}
+	}
+
+
+	template <typename Log>
+	inline void _client_socket<Log>::set_cork(bool is_corked) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10448, "_client_socket::set_cork() is_corked=%d", is_corked);
+		}
+
+		if (base::protocol() != socket::protocol::tcp) {
+			return;
+		}
+
+		int value = is_corked ? 1 : 0;
+		if (::setsockopt(base::handle(), IPPROTO_TCP, TCP_CORK, &value, sizeof(value)) < 0) {
+			throw exception<std::runtime_error, Log>("::setsockopt(TCP_CORK)", 0x10449, log_local);
+		}
+	}
+
+
+	template <typename Log>
+	inline void _client_socket<Log>::set_no_delay(bool is_no_delay) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x1044a, "_client_socket::set_no_delay() is_no_delay=%d", is_no_delay);
+		}
+
+		if (base::protocol() != socket::protocol::tcp) {
+			return;
+		}
+
+		int value = is_no_delay ? 1 : 0;
+		if (::setsockopt(base::handle(), IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value)) < 0) {
+			throw exception<std::runtime_error, Log>("::setsockopt(TCP_NODELAY)", 0x1044b, log_local);
+		}
+	}
+
+
+	template <typename Log>
+	inline socket::status_t _client_socket<Log>::try_connect(const sockaddr& addr, socklen_t addr_size, socket::deadline_t deadline) {
+		// Each address is tried on a fresh non-blocking socket.
+		base::open();
+		base::set_blocking(false);
+
+		if (::connect(base::handle(), &addr, addr_size) == 0) {
+			return socket::status::done;
+		}
+		else if (errno != EINPROGRESS) {
+			return socket::status::closed;
+		}
+
+		socket::status_t status = wait(POLLOUT, deadline);
+
+		if (status == socket::status::done) {
+			int err = 0;
+			socklen_t err_size = sizeof(err);
+			::getsockopt(base::handle(), SOL_SOCKET, SO_ERROR, &err, &err_size);
+
+			if (err != 0) {
+				status = socket::status::closed;
+			}
+		}
+
+		return status;
+	}
+
+
+	template <typename Log>
+	inline socket::status_t _client_socket<Log>::wait(short events, socket::deadline_t deadline) {
+		pollfd handle_poll = { base::handle(), events, 0 };
+		int result;
+
+		do {
+			socket::clock::duration remaining = deadline - socket::clock::now();
+			long long remaining_ms = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+
+			socket::clock::time_point begin = base::stats_begin();
+			result = ::poll(&handle_poll, 1, static_cast<int>(std::clamp(remaining_ms, 0LL, static_cast<long long>(INT_MAX))));
+			base::stats_end_wait(begin);
+		}
+		while (result < 0 && errno == EINTR);
+
+		if (result < 0) {
+			throw exception<std::runtime_error, Log>("::poll()", 0x103c6, base::log());
+		}
+
+		return result == 0 ? socket::status::timeout : socket::status::done;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Log>
+	inline udp_socket<Log>::udp_socket(Log* log)
+		: udp_socket<Log>(socket::family::ipv4, log) {
+	}
+
+
+	template <typename Log>
+	inline udp_socket<Log>::udp_socket(socket::family_t family, Log* log)
+		: _client_socket<Log>(socket::kind::dgram, family, log)
+		, _is_segmentation_unsupported(false) {
+	}
+
+
+	template <typename Log>
+	inline void udp_socket<Log>::send_batch(const iovec* vector, std::size_t count, socket::address* addresses) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x1039a, "udp_socket::send_batch() >>> count=%lu", (std::uint32_t)count);
+		}
+
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x1039b, log_local);
+		}
+
+		mmsghdr messages[batch_size];
+
+		while (count > 0) {
+			std::size_t count_local = std::min(count, batch_size);
+
+			std::memset(messages, 0, count_local * sizeof(mmsghdr));
+			for (std::size_t i = 0; i < count_local; i++) {
+				messages[i].msg_hdr.msg_iov = const_cast<iovec*>(vector + i);
+				messages[i].msg_hdr.msg_iovlen = 1;
+
+				if (addresses != nullptr) {
+					messages[i].msg_hdr.msg_name = &addresses[i].value;
+					messages[i].msg_hdr.msg_namelen = addresses[i].size;
+				}
+			}
+
+			int sent_count;
+			do {
+				socket::clock::time_point begin = base::stats_begin();
+				sent_count = ::sendmmsg(base::handle(), messages, count_local, 0);
+
+				if (base::stats() != nullptr) {
+					std::size_t size = 0;
+					std::size_t sent_size = 0;
+					for (std::size_t i = 0; i < count_local; i++) {
+						size += vector[i].iov_len;
+						sent_size += static_cast<int>(i) < sent_count ? messages[i].msg_len : 0;
+					}
+
+					base::stats_end_send(begin, sent_count < 0 ? -1 : static_cast<ssize_t>(sent_size), size);
+				}
+			}
+			while (sent_count < 0 && errno == EINTR);
+
+			if (sent_count <= 0) {
+				throw exception<std::runtime_error, Log>("::sendmmsg()", 0x1039c, log_local);
+			}
+
+			vector += sent_count;
+			count -= sent_count;
+
+			if (addresses != nullptr) {
+				addresses += sent_count;
+			}
+		}
+
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x1039d, "udp_socket::send_batch() <<<");
+		}
+	}
+
+
+	template <typename Log>
+	inline std::size_t udp_socket<Log>::receive_batch(iovec* vector, std::size_t* sizes, std::size_t count, socket::address* addresses) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x1039e, "udp_socket::receive_batch() >>> count=%lu", (std::uint32_t)count);
+		}
+
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x1039f, log_local);
+		}
+
+		mmsghdr messages[batch_size];
+		std::size_t count_local = std::min(count, batch_size);
+
+		std::memset(messages, 0, count_local * sizeof(mmsghdr));
+		for (std::size_t i = 0; i < count_local; i++) {
+			messages[i].msg_hdr.msg_iov = vector + i;
+			messages[i].msg_hdr.msg_iovlen = 1;
+
+			if (addresses != nullptr) {
+				messages[i].msg_hdr.msg_name = &addresses[i].value;
+				messages[i].msg_hdr.msg_namelen = sizeof(addresses[i].storage);
+			}
+		}
+
+		int received_count;
+		do {
+			socket::clock::time_point begin = base::stats_begin();
+			received_count = ::recvmmsg(base::handle(), messages, count_local, MSG_WAITFORONE, nullptr);
+
+			if (base::stats() != nullptr) {
+				std::size_t received_size = 0;
+				for (int i = 0; i < received_count; i++) {
+					received_size += messages[i].msg_len;
+				}
+
+				base::stats_end_receive(begin, received_count < 0 ? -1 : static_cast<ssize_t>(received_size));
+			}
+		}
+		while (received_count < 0 && errno == EINTR);
+
+		if (received_count < 0) {
+			throw exception<std::runtime_error, Log>("::recvmmsg()", 0x103a0, log_local);
+		}
+
+		for (int i = 0; i < received_count; i++) {
+			sizes[i] = messages[i].msg_len;
+
+			if (addresses != nullptr) {
+				addresses[i].size = messages[i].msg_hdr.msg_namelen;
+			}
+		}
+
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x103a1, "udp_socket::receive_batch() <<< received_count=%d", received_count);
+		}
+
+		return received_count;
+	}
+
+
+	template <typename Log>
+	inline void udp_socket<Log>::send_segmented(const void* buffer, std::size_t size, std::uint16_t segment_size, socket::address* address) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x103a2, "udp_socket::send_segmented() >>> size=%lu, segment_size=%u", (std::uint32_t)size, segment_size);
+		}
+
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x103a3, log_local);
+		}
+
+		// The largest UDP payload over IPv4.
+		constexpr std::size_t max_payload_size = 65507;
+
+		if (segment_size == 0 || segment_size > max_payload_size) {
+			throw exception<std::logic_error, Log>("segment_size", 0x103a4, log_local);
+		}
+
+		const char* chars = static_cast<const char*>(buffer);
+
+#ifdef UDP_SEGMENT
+		// The kernel accepts up to 64 segments that fit in a single UDP payload.
+		const std::size_t max_chunk_size = std::min(batch_size, max_payload_size / segment_size) * segment_size;
+
+		// Once the path has refused segmentation offload, don't probe it again on every call.
+		while (!_is_segmentation_unsupported && size > segment_size) {
+			std::size_t chunk_size = std::min(size, max_chunk_size);
+
+			iovec element;
+			element.iov_base = const_cast<char*>(chars);
+			element.iov_len = chunk_size;
+
+			alignas(cmsghdr) char control[CMSG_SPACE(sizeof(std::uint16_t))];
+			std::memset(control, 0, sizeof(control));
+
+			msghdr message = { 0 };
+			message.msg_iov = &element;
+			message.msg_iovlen = 1;
+			message.msg_control = control;
+			message.msg_controllen = sizeof(control);
+
+			if (address != nullptr) {
+				message.msg_name = &address->value;
+				message.msg_namelen = address->size;
+			}
+
+			cmsghdr* control_message = CMSG_FIRSTHDR(&message);
+			control_message->cmsg_level = SOL_UDP;
+			control_message->cmsg_type = UDP_SEGMENT;
+			control_message->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+			std::uint16_t gso_size = static_cast<std::uint16_t>(segment_size);
+			std::memcpy(CMSG_DATA(control_message), &gso_size, sizeof(gso_size));
+
+			ssize_t sent_size;
+			do {
+				socket::clock::time_point begin = base::stats_begin();
+				sent_size = ::sendmsg(base::handle(), &message, 0);
+				base::stats_end_send(begin, sent_size, chunk_size);
+			}
+			while (sent_size < 0 && errno == EINTR);
+
+			if (sent_size < 0) {
+				// EINVAL means the request itself is wrong, so it is not taken as a lack of support.
+				if (errno == EIO || errno == ENOPROTOOPT || errno == EOPNOTSUPP) {
+					// Segmentation offload is not supported on this path. Fall back to batching.
+					if (log_local != nullptr) {
+						log_local->put_any(category::abc::socket, severity::abc::optional, 0x103a5, "udp_socket::send_segmented() UDP_SEGMENT not supported, errno=%d", errno);
+					}
+
+					_is_segmentation_unsupported = true;
+					break;
+				}
+
+				throw exception<std::runtime_error, Log>("::sendmsg()", 0x103a6, log_local);
+			}
+			else if (static_cast<std::size_t>(sent_size) < chunk_size) {
+				throw exception<std::runtime_error, Log>("::sendmsg()", 0x103a7, log_local);
+			}
+
+			chars += chunk_size;
+			size -= chunk_size;
+		}
+#endif
+
+		iovec vector[batch_size];
+		socket::address addresses[batch_size];
+
+		while (size > 0) {
+			std::size_t count = 0;
+
+			while (size > 0 && count < batch_size) {
+				std::size_t segment_size_local = std::min(size, static_cast<std::size_t>(segment_size));
+
+				vector[count].iov_base = const_cast<char*>(chars);
+				vector[count].iov_len = segment_size_local;
+
+				if (address != nullptr) {
+					addresses[count] = *address;
+				}
+
+				chars += segment_size_local;
+				size -= segment_size_local;
+				count++;
+			}
+
+			send_batch(vector, count, address != nullptr ? addresses : nullptr);
+		}
+
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x103a8, "udp_socket::send_segmented() <<<");
+		}
+	}
+
+
+	template <typename Log>
+	inline void udp_socket<Log>::join_group(const char* group, unsigned interface_index) {
+		change_membership(group, interface_index, true);
+	}
+
+
+	template <typename Log>
+	inline void udp_socket<Log>::leave_group(const char* group, unsigned interface_index) {
+		change_membership(group, interface_index, false);
+	}
+
+
+	template <typename Log>
+	inline void udp_socket<Log>::change_membership(const char* group, unsigned interface_index, bool is_join) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x1045c, "udp_socket::change_membership() group=%s, interface_index=%u, is_join=%d", group, interface_index, is_join);
+		}
+
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x1045d, log_local);
+		}
+
+		int result;
+		if (base::family() == socket::family::ipv4) {
+			ip_mreqn request = { 0 };
+			if (::inet_pton(AF_INET, group, &request.imr_multiaddr) != 1) {
+				throw exception<std::logic_error, Log>("group", 0x1045e, log_local);
+			}
+			request.imr_ifindex = static_cast<int>(interface_index);
+
+			result = ::setsockopt(base::handle(), IPPROTO_IP, is_join ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP, &request, sizeof(request));
+
+#ifdef IP_MULTICAST_ALL
+			// By default, Linux delivers a group's datagrams to every socket bound to the port once any socket on the host has joined.
+			// Limit delivery to the groups this socket has joined.
+			if (result == 0 && is_join) {
+				int value = 0;
+				result = ::setsockopt(base::handle(), IPPROTO_IP, IP_MULTICAST_ALL, &value, sizeof(value));
+			}
+#endif
+		}
+		else if (base::family() == socket::family::ipv6) {
+			ipv6_mreq request = { 0 };
+			if (::inet_pton(AF_INET6, group, &request.ipv6mr_multiaddr) != 1) {
+				throw exception<std::logic_error, Log>("group", 0x1045f, log_local);
+			}
+			request.ipv6mr_interface = interface_index;
+
+			result = ::setsockopt(base::handle(), IPPROTO_IPV6, is_join ? IPV6_JOIN_GROUP : IPV6_LEAVE_GROUP, &request, sizeof(request));
+
+#ifdef IPV6_MULTICAST_ALL
+			if (result == 0 && is_join) {
+				int value = 0;
+				result = ::setsockopt(base::handle(), IPPROTO_IPV6, IPV6_MULTICAST_ALL, &value, sizeof(value));
+			}
+#endif
+		}
+		else {
+			throw exception<std::logic_error, Log>("family", 0x10460, log_local);
+		}
+
+		if (result < 0) {
+			throw exception<std::runtime_error, Log>("::setsockopt(membership)", 0x10461, log_local);
+		}
+	}
+
+
+	template <typename Log>
+	inline void udp_socket<Log>::set_multicast_ttl(int ttl) {
+		set_multicast_option(IP_MULTICAST_TTL, IPV6_MULTICAST_HOPS, &ttl, sizeof(ttl), 0x10462);
+	}
+
+
+	template <typename Log>
+	inline void udp_socket<Log>::set_multicast_loopback(bool is_loopback) {
+		// Both options take a 4-byte integer.
+		unsigned value = is_loopback ? 1 : 0;
+		set_multicast_option(IP_MULTICAST_LOOP, IPV6_MULTICAST_LOOP, &value, sizeof(value), 0x10463);
+	}
+
+
+	template <typename Log>
+	inline void udp_socket<Log>::set_multicast_interface(unsigned interface_index) {
+		if (base::family() == socket::family::ipv4) {
+			ip_mreqn request = { 0 };
+			request.imr_ifindex = static_cast<int>(interface_index);
+			set_multicast_option(IP_MULTICAST_IF, 0, &request, sizeof(request), 0x10464);
+		}
+		else {
+			set_multicast_option(0, IPV6_MULTICAST_IF, &interface_index, sizeof(interface_index), 0x10468);
+		}
+	}
+
+
+	template <typename Log>
+	inline void udp_socket<Log>::set_multicast_option(int ipv4_option, int ipv6_option, const void* value, socklen_t value_size, tag_t tag) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, tag, "udp_socket::set_multicast_option() ipv4_option=%d, ipv6_option=%d", ipv4_option, ipv6_option);
+		}
+
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x10465, log_local);
+		}
+
+		int result;
+		if (base::family() == socket::family::ipv4) {
+			result = ::setsockopt(base::handle(), IPPROTO_IP, ipv4_option, value, value_size);
+		}
+		else if (base::family() == socket::family::ipv6) {
+			result = ::setsockopt(base::handle(), IPPROTO_IPV6, ipv6_option, value, value_size);
+		}
+		else {
+			throw exception<std::logic_error, Log>("family", 0x10466, log_local);
+		}
+
+		if (result < 0) {
+			throw exception<std::runtime_error, Log>("::setsockopt(multicast)", 0x10467, log_local);
+		}
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Log>
+	inline tcp_client_socket<Log>::tcp_client_socket(Log* log)
+		: tcp_client_socket<Log>(socket::family::ipv4, log) {
+	}
+
+
+	template <typename Log>
+	inline tcp_client_socket<Log>::tcp_client_socket(socket::family_t family, Log* log)
+		: _client_socket<Log>(socket::kind::stream, family, log) {
+	}
+
+
+	template <typename Log>
+	inline tcp_client_socket<Log>::tcp_client_socket(socket::handle_t handle, socket::family_t family, Log* log)
+		: _client_socket<Log>(handle, socket::kind::stream, family, log) {
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Log>
+	inline tcp_server_socket<Log>::tcp_server_socket(Log* log)
+		: tcp_server_socket<Log>(socket::family::ipv4, log) {
+	}
+
+
+	template <typename Log>
+	inline tcp_server_socket<Log>::tcp_server_socket(socket::family_t family, Log* log)
+		: _basic_socket<Log>(socket::kind::stream, family, log) {
+	}
+
+
+	template <typename Log>
+	inline void tcp_server_socket<Log>::listen(socket::backlog_size_t backlog_size) {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10022, "tcp_server_socket::listen() >>>");
+		}
+
+		socket::error_t err = ::listen(base::handle(), backlog_size);
+
+		if (err != socket::error::none) {
+			throw exception<std::runtime_error, Log>("::listen()", 0x10023, log_local);
+		}
+
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10024, "tcp_server_socket::listen() <<<");
+		}
+	}
+
+
+	template <typename Log>
+	inline tcp_client_socket<Log> tcp_server_socket<Log>::accept() const {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x10025, "tcp_server_socket::accept() >>>");
+		}
+
+		socket::handle_t hnd;
+		do {
+			hnd = ::accept(base::handle(), nullptr, nullptr);
+		}
+		while (hnd == socket::handle::invalid && errno == EINTR);
+
+		if (hnd == socket::handle::invalid) {
+			// A non-blocking listener has no pending connection. Return a socket that is not open.
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				if (log_local != nullptr) {
+					log_local->put_any(category::abc::socket, severity::abc::debug, 0x10357, "tcp_server_socket::accept() <<< would block");
+				}
+
+				return tcp_client_socket<Log>(socket::handle::invalid, base::family(), base::log());
+			}
+
+			throw exception<std::runtime_error, Log>("::accept()", 0x10026, log_local);
+		}
+
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x10027, "tcp_server_socket::accept() <<<");
+		}
+
+		return tcp_client_socket<Log>(hnd, base::family(), base::log());
+	}
+
+
+	template <typename Log>
+	inline std::size_t tcp_server_socket<Log>::accept_all(socket::handle_t* handles, std::size_t max_count, bool is_blocking) const {
+		Log* log_local = base::log();
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::debug, 0x103ea, "tcp_server_socket::accept_all() >>> max_count=%zu", max_count);
+		}
+
+		if (handles == nullptr) {
+			throw exception<std::logic_error, Log>("tcp_server_socket::accept_all() handles", 0x103eb, log_local);
+		}
+
+		int flags = is_blocking ? SOCK_CLOEXEC : (SOCK_CLOEXEC | SOCK_NONBLOCK);
+		std::size_t count = 0;
+
+		while (count < max_count) {
+			socket::handle_t hnd = ::accept4(base::handle(), nullptr, nullptr, flags);
+
+			if (hnd == socket::handle::invalid) {
+				if (errno == EINTR) {
+					continue;
+				}
+
+				// The backlog is drained.
+				if (errno == EAGAIN || errno == EWOULDBLOCK) {
+					break;
+				}
+
+				// Hand off what has been accepted so far. The error will come up again on the next call.
+				if (count > 0) {
+					break;
+				}
+
+				throw exception<std::runtime_error, Log>("::accept4()", 0x103ec, log_local);
+			}
+
+			handles[count++] = hnd;
+		}
+
+		if (log_local != nullptr) {
+			log_local->put_any(category::abc::socket, severity::abc::optional, 0x103ed, "tcp_server_socket::accept_all() <<< count=%zu", count);
+		}
+
+		return count;
+	}
+
+
+	template <typename Log>
+	template <typename Uring>
+	inline bool tcp_server_socket<Log>::prepare_accept(Uring& ring, std::uint64_t user_data) const {
+		if (!base::is_open()) {
+			throw exception<std::logic_error, Log>("!is_open()", 0x104c2, base::log());
+		}
+
+		return ring.prepare_accept(base::handle(), user_data);
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline socket_streambuf<Socket, Log, GetSize, PutSize>::socket_streambuf(Socket* socket, Log* log)
+		: base()
+		, _socket(socket)
+		, _get_ring(nullptr)
+		, _log(log)
+		, _received_size(0)
+		, _coalescing_size(0)
+		, _is_corked(false)
+		, _is_in_response(false) {
+		static_assert(GetSize > 0, "A socket_streambuf without a ring_buffer must have a positive GetSize.");
+
+		init();
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline socket_streambuf<Socket, Log, GetSize, PutSize>::socket_streambuf(Socket* socket, ring_buffer<Log>* get_ring, Log* log)
+		: base()
+		, _socket(socket)
+		, _get_ring(get_ring)
+		, _log(log)
+		, _received_size(0)
+		, _coalescing_size(0)
+		, _is_corked(false)
+		, _is_in_response(false) {
+		static_assert(GetSize == 0, "A socket_streambuf with a ring_buffer must have a GetSize of 0.");
+
+		if (get_ring == nullptr) {
+			throw exception<std::logic_error, Log>("get_ring", 0x104c4, _log);
+		}
+
+		init();
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline void socket_streambuf<Socket, Log, GetSize, PutSize>::init() {
+		if (_socket == nullptr) {
+			throw exception<std::logic_error, Log>("socket", 0x10068, _log);
+		}
+
+		if constexpr (GetSize == 0) {
+			_get_ring->clear();
+			setg(_get_ring->data(), _get_ring->data(), _get_ring->data());
+		}
+		else {
+			setg(this->_get_buffer, this->_get_buffer, this->_get_buffer);
+		}
+
+		setp(_put_buffer, _put_buffer + PutSize);
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline std::streambuf::int_type socket_streambuf<Socket, Log, GetSize, PutSize>::underflow() {
+		if (gptr() < egptr()) {
+			return traits_type::to_int_type(*gptr());
+		}
+
+		std::size_t received_size = receive_get_area();
+
+		if (received_size == 0) {
+			if (_log != nullptr) {
+				_log->put_any(category::abc::socket, severity::abc::debug, 0x10345, "socket_streambuf::underflow() eof");
+			}
+
+			return traits_type::eof();
+		}
+
+		return traits_type::to_int_type(*gptr());
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline std::streamsize socket_streambuf<Socket, Log, GetSize, PutSize>::xsgetn(char* s, std::streamsize count) {
+		std::streamsize gcount = 0;
+
+		while (gcount < count) {
+			std::streamsize available = egptr() - gptr();
+
+			if (available > 0) {
+				// Serve what is already buffered.
+				std::streamsize chunk = std::min(available, count - gcount);
+				std::memcpy(s + gcount, gptr(), chunk);
+				gbump(static_cast<int>(chunk));
+				gcount += chunk;
+			}
+			else if (count - gcount >= static_cast<std::streamsize>(get_capacity())) {
+				// The remainder wouldn't fit in the buffer anyway - receive it directly into the caller's buffer.
+				std::size_t received_size = _socket->receive_some(s + gcount, count - gcount);
+				if (received_size == 0) {
+					break;
+				}
+
+				_received_size += received_size;
+				gcount += received_size;
+			}
+			else if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+				break;
+			}
+		}
+
+		return gcount;
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline std::streambuf::int_type socket_streambuf<Socket, Log, GetSize, PutSize>::overflow(std::streambuf::int_type ch) {
+		send_put_area();
+
+		if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(ch);
+			pbump(1);
+		}
+
+		return traits_type::not_eof(ch);
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline std::streamsize socket_streambuf<Socket, Log, GetSize, PutSize>::xsputn(const char* s, std::streamsize count) {
+		if (count > epptr() - pptr()) {
+			if (count >= static_cast<std::streamsize>(PutSize)) {
+				begin_send();
+
+				// The data wouldn't fit in the buffer anyway - send it directly from the caller's buffer
+				// together with whatever is pending in the buffer in a single vectored write.
+				if (pptr() > pbase()) {
+					iovec vector[2];
+					vector[0].iov_base = pbase();
+					vector[0].iov_len = pptr() - pbase();
+					vector[1].iov_base = const_cast<char*>(s);
+					vector[1].iov_len = count;
+
+					_socket->send(vector, 2);
+				}
+				else {
+					_socket->send(s, count);
+				}
+
+				setp(_put_buffer, _put_buffer + PutSize);
+				return count;
+			}
+
+			send_put_area();
+		}
+
+		std::memcpy(pptr(), s, count);
+		pbump(static_cast<int>(count));
+
+		return count;
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline int socket_streambuf<Socket, Log, GetSize, PutSize>::sync() {
+		// Outside of a response, nothing would send the held bytes later.
+		// Within a response, nothing sends them on a timer either - they wait for the threshold, a full put area, or end_response().
+		if (_is_in_response && static_cast<std::size_t>(pptr() - pbase()) < _coalescing_size) {
+			return 0;
+		}
+
+		send_put_area();
 
 		return 0;
 	}
 
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline void socket_streambuf<Socket, Log, GetSize, PutSize>::send_file(int file_handle, off_t offset, std::size_t size) {
+		send_put_area();
+		begin_send();
+
+		_socket->send_file(file_handle, offset, size);
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline std::size_t socket_streambuf<Socket, Log, GetSize, PutSize>::fill_get_area(std::size_t size) {
+		size = std::min(size, get_capacity());
+
+		while (static_cast<std::size_t>(egptr() - gptr()) < size) {
+			if (receive_get_area() == 0) {
+				break;
+			}
+		}
+
+		return egptr() - gptr();
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline std::size_t socket_streambuf<Socket, Log, GetSize, PutSize>::consumed_size() const noexcept {
+		return _received_size - (egptr() - gptr());
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline void socket_streambuf<Socket, Log, GetSize, PutSize>::set_coalescing(std::size_t threshold_size) {
+		_coalescing_size = threshold_size;
+
+		// The coalescing here takes the place of Nagle's algorithm.
+		if (_coalescing_size > 0) {
+			_socket->set_no_delay(true);
+		}
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline void socket_streambuf<Socket, Log, GetSize, PutSize>::begin_response() noexcept {
+		_is_in_response = true;
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline void socket_streambuf<Socket, Log, GetSize, PutSize>::end_response() {
+		_is_in_response = false;
+		send_put_area();
+
+		// Releasing the cork sends the last partial segment right away.
+		if (_is_corked) {
+			_socket->set_cork(false);
+			_is_corked = false;
+		}
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline void socket_streambuf<Socket, Log, GetSize, PutSize>::begin_send() {
+		// Cork the socket on the first send of a response, so the rest of the response can fill the segments.
+		if (_coalescing_size > 0 && !_is_corked) {
+			_socket->set_cork(true);
+			_is_corked = true;
+		}
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline std::size_t socket_streambuf<Socket, Log, GetSize, PutSize>::get_capacity() const noexcept {
+		if constexpr (GetSize == 0) {
+			return _get_ring->capacity();
+		}
+		else {
+			return GetSize;
+		}
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline std::size_t socket_streambuf<Socket, Log, GetSize, PutSize>::receive_get_area() {
+		// Receives more bytes after the ones that are still buffered, and resets the get area to span all of them.
+		std::size_t buffered_size = egptr() - gptr();
+		std::size_t received_size;
+
+		if constexpr (GetSize == 0) {
+			_get_ring->consume(gptr() - eback());
+			received_size = _get_ring->space_size() > 0 ? _socket->receive_some(_get_ring->space(), _get_ring->space_size()) : 0;
+			_get_ring->commit(received_size);
+
+			setg(_get_ring->data(), _get_ring->data(), _get_ring->data() + _get_ring->size());
+		}
+		else {
+			// The fixed buffer has to be compacted first.
+			std::memmove(this->_get_buffer, gptr(), buffered_size);
+			received_size = buffered_size < GetSize ? _socket->receive_some(this->_get_buffer + buffered_size, GetSize - buffered_size) : 0;
+
+			setg(this->_get_buffer, this->_get_buffer, this->_get_buffer + buffered_size + received_size);
+		}
+
+		_received_size += received_size;
+
+		return received_size;
+	}
+
+
+	template <typename Socket, typename Log, std::size_t GetSize, std::size_t PutSize>
+	inline void socket_streambuf<Socket, Log, GetSize, PutSize>::send_put_area() {
+		if (pptr() > pbase()) {
+			begin_send();
+			_socket->send(pbase(), pptr() - pbase());
+		}
+
+		setp(_put_buffer, _put_buffer + PutSize);
+	}
+
 }
@@ -26,14 +26,27 @@ SOFTWARE.
 #pragma once
 
 #include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <atomic>
 #include <streambuf>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/un.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
+#include <netinet/tcp.h>
 #include <netdb.h>
 #include <unistd.h>
 
+#include "size.h"
 #include "log.i.h"
+#include "buffer_streambuf.h"
+#include "ring_buffer.i.h"
 
 
 namespace abc {
@@ -52,6 +65,9 @@ namespace abc {
 		namespace family {
 			constexpr family_t	ipv4	= AF_INET;
 			constexpr family_t	ipv6	= AF_INET6;
+
+			// Same-host IPC. The port is a file system path, or a name in the abstract namespace if it starts with '@'.
+			constexpr family_t	local	= AF_UNIX;
 		}
 
 
@@ -60,6 +76,7 @@ namespace abc {
 		namespace protocol {
 			constexpr protocol_t	tcp	= IPPROTO_TCP;
 			constexpr protocol_t	udp	= IPPROTO_UDP;
+			constexpr protocol_t	local	= 0;
 		}
 
 
@@ -78,6 +95,20 @@ namespace abc {
 		}
 
 
+		using status_t = std::uint8_t;
+
+		namespace status {
+			constexpr status_t	done		= 0;
+			constexpr status_t	would_block	= 1;
+			constexpr status_t	closed		= 2;
+			constexpr status_t	timeout		= 3;
+		}
+
+
+		using clock = std::chrono::steady_clock;
+		using deadline_t = clock::time_point;
+
+
 		using tie_t = std::uint8_t;
 
 		namespace tie {
@@ -87,10 +118,16 @@ namespace abc {
 
 
 		struct address {
-			sockaddr		value;
-			socklen_t		size = sizeof(sockaddr);
+			union {
+				sockaddr			value;
+				sockaddr_storage	storage;
+			};
+			socklen_t		size = sizeof(sockaddr_storage);
 		};
 
+		// Returns an address of family::local. If the path is too long, the returned address has a size of 0.
+		address local_address(const char* path) noexcept;
+
 		using backlog_size_t = int;
 	}
 
@@ -98,6 +135,80 @@ namespace abc {
 	// --------------------------------------------------------------
 
 
+	// Remembers which address each host:port was last connected to, so that reconnecting doesn't have to go to the resolver.
+	// Entries expire after ttl. When the cache is full, the entry that expires first is replaced.
+	template <std::size_t Size = size::_32>
+	class address_cache {
+	public:
+		address_cache(std::chrono::milliseconds ttl = std::chrono::seconds(30));
+		address_cache(address_cache&& other) = delete;
+		address_cache(const address_cache& other) = delete;
+
+	public:
+		bool			lookup(const char* host, const char* port, socket::kind_t kind, socket::family_t family, sockaddr_storage& addr, socklen_t& addr_size);
+		void			put(const char* host, const char* port, socket::kind_t kind, socket::family_t family, const sockaddr& addr, socklen_t addr_size);
+		void			remove(const char* host, const char* port, socket::kind_t kind, socket::family_t family);
+		void			clear();
+
+		std::size_t		hit_count() const noexcept;
+		std::size_t		miss_count() const noexcept;
+
+	private:
+		struct entry {
+			char						host[size::_256];
+			char						port[size::_16];
+			socket::kind_t				kind;
+			socket::family_t			family;
+			sockaddr_storage			addr;
+			socklen_t					addr_size;
+			socket::clock::time_point	expires_at;
+		};
+
+		entry*			find(const char* host, const char* port, socket::kind_t kind, socket::family_t family) noexcept;
+
+	private:
+		const std::chrono::milliseconds	_ttl;
+
+		std::mutex						_mutex;
+		entry							_entries[Size];
+		std::atomic_size_t				_hit_count;
+		std::atomic_size_t				_miss_count;
+	};
+
+
+	namespace socket {
+		// The cache that _basic_socket uses when connecting by host and port.
+		address_cache<>&	default_address_cache();
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	// I/O counters. A socket counts into the socket_stats attached to it with set_stats(). A socket with none attached counts nothing.
+	// Multiple sockets, possibly on different threads, may share the same socket_stats.
+	struct socket_stats {
+		std::atomic_uint64_t	send_calls			{ 0 };
+		std::atomic_uint64_t	receive_calls		{ 0 };
+		std::atomic_uint64_t	wait_calls			{ 0 };
+
+		std::atomic_uint64_t	bytes_sent			{ 0 };
+		std::atomic_uint64_t	bytes_received		{ 0 };
+
+		// Send calls that took fewer bytes than were given.
+		std::atomic_uint64_t	partial_sends		{ 0 };
+
+		// Calls that failed with EAGAIN/EWOULDBLOCK.
+		std::atomic_uint64_t	would_block_count	{ 0 };
+
+		// Time spent inside send, receive, and wait calls.
+		std::atomic_uint64_t	blocked_ns			{ 0 };
+	};
+
+
+	// --------------------------------------------------------------
+
+
 	template <typename Log>
 	class _basic_socket {
 	protected:
@@ -113,6 +224,17 @@ namespace abc {
 		void				close() noexcept;
 		void				bind(const char* port);
 		void				bind(const char* host, const char* port);
+		void				bind(const socket::address& address);
+		void				set_blocking(bool is_blocking);
+
+		// Lets multiple sockets bind to the same port, and the kernel balance incoming connections/datagrams among them.
+		// Takes effect on the next bind.
+		void				set_reuse_port(bool is_reuse_port) noexcept;
+		socket::handle_t	handle() const noexcept;
+
+		// Starts or stops counting I/O into stats. stats must outlive the socket or be detached first.
+		void				set_stats(socket_stats* stats) noexcept;
+		socket_stats*		stats() const noexcept;
 
 	protected:
 		void				open();
@@ -129,14 +251,22 @@ namespace abc {
 		socket::kind_t		kind() const noexcept;
 		socket::family_t	family() const noexcept;
 		socket::protocol_t	protocol() const noexcept;
-		socket::handle_t	handle() const noexcept;
 		Log*				log() const noexcept;
 
+	protected:
+		// Each system call is bracketed by stats_begin() and one of the stats_end_*() methods. Both are no-ops when there are no stats.
+		socket::clock::time_point	stats_begin() const noexcept;
+		void						stats_end_send(socket::clock::time_point begin, ssize_t sent_size, std::size_t size) noexcept;
+		void						stats_end_receive(socket::clock::time_point begin, ssize_t received_size) noexcept;
+		void						stats_end_wait(socket::clock::time_point begin) noexcept;
+
 	private:
 		socket::kind_t		_kind;
 		socket::family_t	_family;
 		socket::protocol_t	_protocol;
 		socket::handle_t	_handle;
+		bool				_is_reuse_port;
+		socket_stats*		_stats;
 		Log*				_log;
 	};
 
@@ -160,6 +290,42 @@ namespace abc {
 
 		void send(const void* buffer, std::size_t size, socket::address* address = nullptr);
 		void receive(void* buffer, std::size_t size, socket::address* address = nullptr);
+
+		std::size_t receive_some(void* buffer, std::size_t size);
+
+		void send(const iovec* vector, std::size_t count);
+		void receive(iovec* vector, std::size_t count);
+
+		// Sends size bytes of an open file, starting at offset, without copying them through user space.
+		void send_file(int file_handle, off_t offset, std::size_t size);
+
+		socket::status_t try_send(const void* buffer, std::size_t size, std::size_t& sent_size);
+		socket::status_t try_receive(void* buffer, std::size_t size, std::size_t& received_size);
+
+		// Queue a send or a receive on a uring, so that it is submitted in a batch together with other sockets' operations.
+		// Returns false if the submission queue is full. The result comes back as a completion with the given user_data.
+		template <typename Uring>
+		bool prepare_send(Uring& ring, const void* buffer, std::size_t size, std::uint64_t user_data);
+		template <typename Uring>
+		bool prepare_receive(Uring& ring, void* buffer, std::size_t size, std::uint64_t user_data);
+
+		// Give up at the deadline, and return socket::status::timeout instead of throwing.
+		// A connect() that times out closes the socket. A send() or receive() that times out may have transferred part of the buffer.
+		socket::status_t connect(const char* host, const char* port, socket::deadline_t deadline);
+		socket::status_t send(const void* buffer, std::size_t size, socket::deadline_t deadline);
+		socket::status_t receive(void* buffer, std::size_t size, socket::deadline_t deadline);
+
+		// Makes the blocking send() and receive() throw when the peer has been idle for that long.
+		void set_idle_timeout(std::chrono::milliseconds timeout);
+
+		// TCP_CORK holds back partial segments until it is released. TCP_NODELAY sends small segments without waiting for ACKs.
+		// Both are ignored on sockets that are not TCP.
+		void set_cork(bool is_corked);
+		void set_no_delay(bool is_no_delay);
+
+	private:
+		socket::status_t try_connect(const sockaddr& addr, socklen_t addr_size, socket::deadline_t deadline);
+		socket::status_t wait(short events, socket::deadline_t deadline);
 	};
 
 
@@ -175,14 +341,49 @@ namespace abc {
 		udp_socket(Log* log);
 		udp_socket(udp_socket&& other) noexcept = default;
 		udp_socket(const udp_socket& other) = delete;
-	};
 
+	public:
+		// Datagram i is taken from vector[i]. If addresses is not nullptr, it is sent to addresses[i].
+		void			send_batch(const iovec* vector, std::size_t count, socket::address* addresses = nullptr);
 
-	// --------------------------------------------------------------
+		// Blocks until at least one datagram arrives, and then receives whatever else is ready, up to count.
+		// Datagram i is stored in vector[i], and its size is stored in sizes[i]. Returns the number of datagrams received.
+		std::size_t		receive_batch(iovec* vector, std::size_t* sizes, std::size_t count, socket::address* addresses = nullptr);
 
+		// Sends the buffer as datagrams of segment_size bytes each (the last one may be shorter).
+		// Uses UDP segmentation offload where available, and falls back to send_batch() otherwise.
+		// Once the path has refused segmentation offload, this socket keeps using send_batch().
+		void			send_segmented(const void* buffer, std::size_t size, std::uint16_t segment_size, socket::address* address = nullptr);
 
-	template <typename Log>
-	class tcp_server_socket;
+	public:
+		// Multicast. The socket must be bound (to receive) or connected (to send) first.
+		// A subscriber binds to the group's port, and joins the group. Multiple subscribers on the same host should set_reuse_port() before binding.
+		// A publisher connects to the group's address and port, so that each send reaches every subscriber.
+		// interface_index is an index as returned by if_nametoindex(). 0 lets the kernel pick the interface.
+		void			join_group(const char* group, unsigned interface_index = 0);
+		void			leave_group(const char* group, unsigned interface_index = 0);
+
+		// The number of hops (routers) outgoing multicast datagrams may cross. The default is 1 - the local segment.
+		void			set_multicast_ttl(int ttl);
+
+		// Whether outgoing multicast datagrams are delivered to subscribers on this host too. The default is true.
+		void			set_multicast_loopback(bool is_loopback);
+
+		// The interface outgoing multicast datagrams are sent through.
+		void			set_multicast_interface(unsigned interface_index);
+
+	private:
+		void			change_membership(const char* group, unsigned interface_index, bool is_join);
+		void			set_multicast_option(int ipv4_option, int ipv6_option, const void* value, socklen_t value_size, tag_t tag);
+
+	private:
+		static constexpr std::size_t batch_size = size::_64;
+
+		bool			_is_segmentation_unsupported;
+	};
+
+
+	// --------------------------------------------------------------
 
 
 	template <typename Log = null_log>
@@ -195,8 +396,7 @@ namespace abc {
 		tcp_client_socket(tcp_client_socket&& other) noexcept = default;
 		tcp_client_socket(const tcp_client_socket& other) = delete;
 
-	protected:
-		friend class tcp_server_socket<Log>;
+		// Takes ownership of a handle that has already been accepted or connected.
 		tcp_client_socket(socket::handle_t handle, socket::family_t family, Log* log);
 	};
 
@@ -216,30 +416,103 @@ namespace abc {
 
 	public:
 		void					listen(socket::backlog_size_t backlog_size);
+
+		// If the listener is non-blocking and there is no pending connection, the returned socket is not open.
 		tcp_client_socket<Log>	accept() const;
+
+		// Drains the pending connections with accept4() until the backlog is empty or max_count handles have been accepted.
+		// The listener should be non-blocking. The accepted handles are close-on-exec, and non-blocking unless is_blocking is true.
+		// Returns the number of handles stored in handles.
+		std::size_t				accept_all(socket::handle_t* handles, std::size_t max_count, bool is_blocking = false) const;
+
+		// Queues an accept on a uring. The completion's result is the accepted handle.
+		template <typename Uring>
+		bool					prepare_accept(Uring& ring, std::uint64_t user_data) const;
 	};
 
 
 	// --------------------------------------------------------------
 
 
-	template <typename Socket, typename Log = null_log>
-	class socket_streambuf : public std::streambuf {
-		using base = std::streambuf;
+	// The fixed get buffer of a socket_streambuf. A socket_streambuf whose get area is backed by a ring_buffer has none.
+	template <std::size_t GetSize>
+	struct _socket_get_buffer {
+		char		_get_buffer[GetSize];
+	};
+
+
+	template <>
+	struct _socket_get_buffer<0> {
+	};
+
+
+	// A GetSize of 0 means the get area is backed by a ring_buffer that is passed in to the constructor.
+	template <typename Socket, typename Log = null_log, std::size_t GetSize = size::k1, std::size_t PutSize = size::k1>
+	class socket_streambuf : public span_streambuf, private _socket_get_buffer<GetSize> {
+		using base = span_streambuf;
+
+		static_assert(PutSize > 0, "PutSize must be positive.");
 
 	public:
+		// Requires GetSize > 0.
 		socket_streambuf(Socket* socket, Log* log = nullptr);
 
+		// Requires GetSize == 0. The get area is backed by get_ring instead of a fixed buffer.
+		// Buffered bytes never need to be moved to make room for more, because they stay contiguous when the ring wraps.
+		socket_streambuf(Socket* socket, ring_buffer<Log>* get_ring, Log* log = nullptr);
+
 	protected:
-		virtual int_type	underflow() override;
-		virtual int_type	overflow(int_type ch) override;
-		virtual int			sync() override;
+		virtual int_type		underflow() override;
+		virtual std::streamsize	xsgetn(char* s, std::streamsize count) override;
+		virtual int_type		overflow(int_type ch) override;
+		virtual std::streamsize	xsputn(const char* s, std::streamsize count) override;
+		virtual int				sync() override;
+
+	public:
+		// Sends any pending bytes first, and then the file.
+		void					send_file(int file_handle, off_t offset, std::size_t size);
+
+		// Receives until at least size bytes are buffered contiguously from gptr(), or until the peer closes the connection.
+		// size is capped at the capacity of the get area. Returns the number of bytes buffered.
+		std::size_t				fill_get_area(std::size_t size);
+
+		// The number of bytes that have been read from this streambuf so far, i.e. received and no longer buffered.
+		std::size_t				consumed_size() const noexcept;
+
+		// Between begin_response() and end_response(), makes sync() hold the pending bytes until at least threshold_size of them are pending.
+		// There is no deadline - bytes below the threshold stay held until the put area fills up or end_response() is called,
+		// so a handler that flushes and then blocks for long, e.g. between the chunks of a streamed body, should end the response or turn coalescing off.
+		// The socket is corked, so that partial segments are held back as well.
+		// Outside of a response, sync() always sends. A threshold_size of 0 turns coalescing off.
+		void					set_coalescing(std::size_t threshold_size);
+
+		// Starts holding back small flushes, if coalescing is on.
+		void					begin_response() noexcept;
+
+		// Sends all the pending bytes, releases the cork, and stops holding back flushes.
+		void					end_response();
+
+	private:
+		void					send_put_area();
+		void					begin_send();
+		std::size_t				get_capacity() const noexcept;
+		std::size_t				receive_get_area();
+		void					init();
 
 	private:
-		Socket*		_socket;
-		Log*		_log;
-		char		_get_ch;
-		char		_put_ch;
+		Socket*						_socket;
+		ring_buffer<Log>*			_get_ring;
+		Log*						_log;
+		std::size_t					_received_size;
+
+		std::size_t					_coalescing_size;
+		bool						_is_corked;
+		bool						_is_in_response;
+		char		_put_buffer[PutSize];
 	};
 
+
+	template <typename Socket, typename Log>
+	socket_streambuf(Socket* socket, ring_buffer<Log>* get_ring, Log* log) -> socket_streambuf<Socket, Log, 0>;
+
 }
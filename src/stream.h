@@ -25,6 +25,9 @@ SOFTWARE.
 
 #pragma once
 
+#include <cstring>
+#include <algorithm>
+
 #include "log.h"
 #include "stream.i.h"
 
@@ -124,7 +127,8 @@ namespace abc {
 
 	inline _istream::_istream(std::streambuf* sb)
 		: base(sb)
-		, _gcount(0) {
+		, _gcount(0)
+		, _span_sb(dynamic_cast<span_streambuf*>(sb)) {
 	}
 
 
@@ -144,6 +148,61 @@ namespace abc {
 	}
 
 
+	template <typename Predicate>
+	inline std::size_t _istream::get_span_chars(Predicate&& predicate, char* buffer, std::size_t size) {
+		return get_span_run([&predicate] (const char* begin, const char* end) { return std::find_if_not(begin, end, predicate); }, buffer, size);
+	}
+
+
+	template <typename Find>
+	inline std::size_t _istream::get_span_run(Find&& find, char* buffer, std::size_t size) {
+		if (_span_sb == nullptr) {
+			return 0;
+		}
+
+		std::size_t gcount = 0;
+
+		while (gcount < size && base::is_good()) {
+			// peek_span() may refill the get area, which may throw. Like the std::istream sentry, turn that into badbit.
+			char_span span { };
+			try {
+				span = _span_sb->peek_span();
+			}
+			catch (...) {
+				base::set_bad();
+
+				if ((base::exceptions() & std::ios_base::badbit) != 0) {
+					throw;
+				}
+
+				break;
+			}
+
+			std::size_t max_size = std::min(span.size, size - gcount);
+
+			std::size_t run_size = find(span.data, span.data + max_size) - span.data;
+
+			if (run_size == 0) {
+				break;
+			}
+
+			if (buffer != nullptr) {
+				std::memcpy(buffer + gcount, span.data, run_size);
+			}
+
+			_span_sb->consume(run_size);
+			gcount += run_size;
+
+			// The run ended before the buffered chars did, so the next char doesn't match.
+			if (run_size < span.size) {
+				break;
+			}
+		}
+
+		return gcount;
+	}
+
+
 	// --------------------------------------------------------------
 
 
@@ -29,6 +29,8 @@ SOFTWARE.
 #include <istream>
 #include <ostream>
 
+#include "buffer_streambuf.h"
+
 
 namespace abc {
 
@@ -76,8 +78,20 @@ namespace abc {
 	protected:
 		void			reset();
 		void			set_gcount(std::size_t gcount) noexcept;
+
+		// If the streambuf is a span_streambuf, consumes the buffered chars a whole run at a time while predicate holds.
+		// They are copied to buffer, unless buffer is nullptr, up to size chars. Returns the number of chars consumed.
+		// The caller should finish with its char-at-a-time loop, which deals with the end of the stream and with invalid chars.
+		template <typename Predicate>
+		std::size_t		get_span_chars(Predicate&& predicate, char* buffer, std::size_t size);
+
+		// Same as get_span_chars(), except that the run is found by find(begin, end), which returns the first char that doesn't belong to it.
+		template <typename Find>
+		std::size_t		get_span_run(Find&& find, char* buffer, std::size_t size);
+
 	private:
 		std::size_t		_gcount;
+		span_streambuf*	_span_sb;
 	};
 
 
@@ -0,0 +1,304 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <thread>
+
+#include "timer_wheel.i.h"
+
+
+namespace abc {
+
+	template <std::size_t Size, typename Log>
+	inline timer_wheel<Size, Log>::timer_wheel(std::chrono::milliseconds tick, Log* log)
+		: _tick(tick.count() > 0 ? tick : std::chrono::milliseconds(1))
+		, _start(clock::now())
+		, _free_head(0)
+		, _pending_count(0)
+		, _current_tick(0)
+		, _firing_id(timer_id::invalid)
+		, _is_stopped(false)
+		, _log(log) {
+		for (std::size_t i = 0; i < Size; i++) {
+			_entries[i].handler = nullptr;
+			_entries[i].expiry = 0;
+			_entries[i].generation = 1;
+			_entries[i].list = no_index;
+			_entries[i].prev = no_index;
+			_entries[i].next = i + 1 < Size ? static_cast<index_t>(i + 1) : no_index;
+		}
+
+		for (index_t list = 0; list < list_count; list++) {
+			_lists[list] = no_index;
+		}
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline timer_id_t timer_wheel<Size, Log>::schedule(std::chrono::milliseconds delay, timer_handler* handler) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::timer, severity::abc::debug, 0x1041c, "timer_wheel::schedule() delay=%lld", (long long)delay.count());
+		}
+
+		std::uint64_t now_tick = static_cast<std::uint64_t>((clock::now() - _start) / _tick);
+		std::uint64_t delay_ticks = static_cast<std::uint64_t>(std::max((delay + _tick - std::chrono::milliseconds(1)) / _tick, std::chrono::milliseconds::rep(1)));
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (_free_head == no_index) {
+			if (_log != nullptr) {
+				_log->put_any(category::abc::timer, severity::abc::optional, 0x1041d, "timer_wheel::schedule() full");
+			}
+
+			return timer_id::invalid;
+		}
+
+		index_t index = _free_head;
+		_free_head = _entries[index].next;
+
+		// The wheel may lag behind the clock if it hasn't been advanced recently. Count from the clock.
+		_entries[index].handler = handler;
+		_entries[index].expiry = std::max(now_tick, _current_tick) + delay_ticks;
+		_pending_count++;
+
+		place(index);
+
+		return (static_cast<timer_id_t>(_entries[index].generation) << 32) | static_cast<timer_id_t>(index + 1);
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline bool timer_wheel<Size, Log>::cancel(timer_id_t id) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::timer, severity::abc::debug, 0x1041e, "timer_wheel::cancel() id=%llx", (unsigned long long)id);
+		}
+
+		std::size_t index = static_cast<std::size_t>(id & 0xffffffff) - 1;
+		std::uint32_t generation = static_cast<std::uint32_t>(id >> 32);
+
+		if (id == timer_id::invalid || index >= Size) {
+			return false;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		if (_entries[index].generation == generation && _entries[index].list != no_index) {
+			release(static_cast<index_t>(index));
+			return true;
+		}
+
+		// The handler may be running on the thread that advances the wheel.
+		_fired_condition.wait(lock, [this, id] () { return _firing_id != id; });
+
+		return false;
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline std::size_t timer_wheel<Size, Log>::advance(clock::time_point now) {
+		std::uint64_t target_tick = now > _start ? static_cast<std::uint64_t>((now - _start) / _tick) : 0;
+		std::size_t fired_count = 0;
+
+		while (true) {
+			timer_handler* handler;
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+
+				// Move the wheel one tick at a time until some timers expire.
+				while (_lists[expired_list] == no_index && _current_tick < target_tick) {
+					_current_tick++;
+
+					// When a level wraps around, the next slot of the level above is spread over the levels below.
+					for (std::size_t level = 1; level < level_count && ((_current_tick >> (slot_bits * (level - 1))) & (slot_count - 1)) == 0; level++) {
+						cascade(level);
+					}
+
+					index_t slot = static_cast<index_t>(_current_tick & (slot_count - 1));
+					while (_lists[slot] != no_index) {
+						index_t index = _lists[slot];
+						unlink(index);
+						link(index, expired_list);
+					}
+				}
+
+				index_t index = _lists[expired_list];
+				if (index == no_index) {
+					break;
+				}
+
+				// Release the entry before the handler is called, so that the handler may schedule new timers.
+				handler = _entries[index].handler;
+				_firing_id = (static_cast<timer_id_t>(_entries[index].generation) << 32) | static_cast<timer_id_t>(index + 1);
+				release(index);
+			}
+
+			handler->on_timer();
+			fired_count++;
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_firing_id = timer_id::invalid;
+			}
+
+			_fired_condition.notify_all();
+		}
+
+		if (_log != nullptr && fired_count > 0) {
+			_log->put_any(category::abc::timer, severity::abc::debug, 0x1041f, "timer_wheel::advance() fired_count=%zu", fired_count);
+		}
+
+		return fired_count;
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline int timer_wheel<Size, Log>::next_timeout_ms() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (_pending_count == 0) {
+			return -1;
+		}
+
+		clock::duration remaining = _tick * (_current_tick + 1) - (clock::now() - _start);
+		return static_cast<int>(std::max(std::chrono::ceil<std::chrono::milliseconds>(remaining).count(), std::chrono::milliseconds::rep(0)));
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline void timer_wheel<Size, Log>::run() {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::timer, severity::abc::optional, 0x10420, "timer_wheel::run() >>>");
+		}
+
+		while (!_is_stopped.load()) {
+			std::this_thread::sleep_for(_tick);
+			advance();
+		}
+
+		if (_log != nullptr) {
+			_log->put_any(category::abc::timer, severity::abc::optional, 0x10421, "timer_wheel::run() <<<");
+		}
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline void timer_wheel<Size, Log>::stop() noexcept {
+		_is_stopped.store(true);
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline std::size_t timer_wheel<Size, Log>::pending_count() const noexcept {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _pending_count;
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline void timer_wheel<Size, Log>::place(index_t index) {
+		// Entries that are due within the current slot of a level go to the level below.
+		constexpr std::uint64_t max_delta = std::uint64_t(1) << (slot_bits * level_count);
+
+		std::uint64_t expiry = _entries[index].expiry;
+		std::uint64_t delta = expiry > _current_tick ? expiry - _current_tick : 0;
+
+		std::size_t level = 0;
+		while (level < level_count - 1 && delta >= (std::uint64_t(1) << (slot_bits * (level + 1)))) {
+			level++;
+		}
+
+		// Entries beyond the reach of the wheel are parked at its far end, and placed again when they get there.
+		std::uint64_t position = delta < max_delta ? std::max(expiry, _current_tick) : _current_tick + max_delta - 1;
+		std::size_t slot = static_cast<std::size_t>(position >> (slot_bits * level)) & (slot_count - 1);
+
+		link(index, static_cast<index_t>(level * slot_count + slot));
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline void timer_wheel<Size, Log>::link(index_t index, index_t list) {
+		entry& e = _entries[index];
+		e.list = list;
+		e.prev = no_index;
+		e.next = _lists[list];
+
+		if (e.next != no_index) {
+			_entries[e.next].prev = index;
+		}
+
+		_lists[list] = index;
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline void timer_wheel<Size, Log>::unlink(index_t index) {
+		entry& e = _entries[index];
+
+		if (e.prev != no_index) {
+			_entries[e.prev].next = e.next;
+		}
+		else {
+			_lists[e.list] = e.next;
+		}
+
+		if (e.next != no_index) {
+			_entries[e.next].prev = e.prev;
+		}
+
+		e.list = no_index;
+		e.prev = no_index;
+		e.next = no_index;
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline void timer_wheel<Size, Log>::release(index_t index) {
+		unlink(index);
+
+		entry& e = _entries[index];
+		e.handler = nullptr;
+		e.generation++;
+		e.next = _free_head;
+		_free_head = index;
+
+		_pending_count--;
+	}
+
+
+	template <std::size_t Size, typename Log>
+	inline void timer_wheel<Size, Log>::cascade(std::size_t level) {
+		index_t list = static_cast<index_t>(level * slot_count + ((_current_tick >> (slot_bits * level)) & (slot_count - 1)));
+
+		while (_lists[list] != no_index) {
+			index_t index = _lists[list];
+			unlink(index);
+			place(index);
+		}
+	}
+
+}
@@ -0,0 +1,140 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "size.h"
+#include "log.i.h"
+
+
+namespace abc {
+
+	using timer_id_t = std::uint64_t;
+
+	namespace timer_id {
+		constexpr timer_id_t	invalid	= 0;
+	}
+
+
+	// --------------------------------------------------------------
+
+
+	// A handler is scheduled together with a delay. on_timer() is called from the thread that advances the wheel.
+	class timer_handler {
+	public:
+		virtual ~timer_handler() noexcept = default;
+
+		virtual void on_timer() = 0;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	// A hierarchical timer wheel of up to Size pending timers.
+	// Scheduling and canceling a timer are O(1). Timers fire on tick boundaries, i.e. up to one tick late.
+	// The wheel is advanced either by a dedicated thread calling run(), or by calling advance() from a reactor loop that waits for next_timeout_ms().
+	template <std::size_t Size = size::k1, typename Log = null_log>
+	class timer_wheel {
+	public:
+		using clock = std::chrono::steady_clock;
+
+		static constexpr std::size_t level_count	= 4;
+		static constexpr std::size_t slot_bits		= 6;
+		static constexpr std::size_t slot_count		= std::size_t(1) << slot_bits;
+
+	public:
+		timer_wheel(std::chrono::milliseconds tick = std::chrono::milliseconds(10), Log* log = nullptr);
+		timer_wheel(timer_wheel&& other) = delete;
+		timer_wheel(const timer_wheel& other) = delete;
+
+	public:
+		// Returns timer_id::invalid if Size timers are already pending.
+		timer_id_t		schedule(std::chrono::milliseconds delay, timer_handler* handler);
+
+		// Returns false if the timer has already fired or has been canceled.
+		// If the timer is firing on another thread, waits for its handler to return, so that the handler may be destroyed after this call.
+		bool			cancel(timer_id_t id);
+
+		// Fires the timers that have expired by now. Returns the number of timers fired.
+		std::size_t		advance(clock::time_point now = clock::now());
+
+		// The number of milliseconds until the next tick, or -1 if there are no pending timers. Suitable for reactor::run_once().
+		int				next_timeout_ms() const;
+
+		// Advances the wheel every tick until stop() is called.
+		void			run();
+		void			stop() noexcept;
+
+		std::size_t		pending_count() const noexcept;
+
+	private:
+		using index_t = std::int32_t;
+
+		static constexpr index_t	no_index		= -1;
+		static constexpr index_t	expired_list	= static_cast<index_t>(level_count * slot_count);
+		static constexpr index_t	list_count		= expired_list + 1;
+
+		struct entry {
+			timer_handler*	handler;
+			std::uint64_t	expiry;
+			std::uint32_t	generation;
+			index_t			list;
+			index_t			prev;
+			index_t			next;
+		};
+
+		void			place(index_t index);
+		void			link(index_t index, index_t list);
+		void			unlink(index_t index);
+		void			release(index_t index);
+		void			cascade(std::size_t level);
+
+	private:
+		const std::chrono::milliseconds	_tick;
+		const clock::time_point			_start;
+
+		mutable std::mutex				_mutex;
+		std::condition_variable			_fired_condition;
+
+		entry							_entries[Size];
+		index_t							_lists[list_count];
+		index_t							_free_head;
+		std::size_t						_pending_count;
+		std::uint64_t					_current_tick;
+		timer_id_t						_firing_id;
+
+		std::atomic_bool				_is_stopped;
+		Log*							_log;
+	};
+
+}
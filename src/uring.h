@@ -0,0 +1,267 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "uring.i.h"
+#include "exception.h"
+
+
+namespace abc {
+
+	template <std::size_t Entries, typename Log>
+	inline uring<Entries, Log>::uring(Log* log)
+		: _handle(-1)
+		, _sq_ring(MAP_FAILED)
+		, _sq_ring_size(0)
+		, _cq_ring(MAP_FAILED)
+		, _cq_ring_size(0)
+		, _sqes(static_cast<io_uring_sqe*>(MAP_FAILED))
+		, _sqes_size(0)
+		, _pending_count(0)
+		, _log(log) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::uring, severity::abc::debug, 0x1036b, "uring::uring() entries=%lu", (std::uint32_t)Entries);
+		}
+
+		io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+
+		_handle = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned>(Entries), &params));
+		if (_handle < 0) {
+			throw exception<std::runtime_error, Log>("::io_uring_setup()", 0x1036c, _log);
+		}
+
+		_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+		// Newer kernels allow both rings to be mapped at once.
+		bool is_single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (is_single_mmap) {
+			_sq_ring_size = _cq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+		}
+
+		_sq_ring = ::mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _handle, IORING_OFF_SQ_RING);
+		if (_sq_ring == MAP_FAILED) {
+			::close(_handle);
+			throw exception<std::runtime_error, Log>("::mmap(IORING_OFF_SQ_RING)", 0x1036d, _log);
+		}
+
+		if (is_single_mmap) {
+			_cq_ring = _sq_ring;
+		}
+		else {
+			_cq_ring = ::mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _handle, IORING_OFF_CQ_RING);
+			if (_cq_ring == MAP_FAILED) {
+				::munmap(_sq_ring, _sq_ring_size);
+				::close(_handle);
+				throw exception<std::runtime_error, Log>("::mmap(IORING_OFF_CQ_RING)", 0x1036e, _log);
+			}
+		}
+
+		_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		_sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _handle, IORING_OFF_SQES));
+		if (_sqes == MAP_FAILED) {
+			if (!is_single_mmap) {
+				::munmap(_cq_ring, _cq_ring_size);
+			}
+			::munmap(_sq_ring, _sq_ring_size);
+			::close(_handle);
+			throw exception<std::runtime_error, Log>("::mmap(IORING_OFF_SQES)", 0x1036f, _log);
+		}
+
+		char* sq_ring = static_cast<char*>(_sq_ring);
+		_sq_head	= reinterpret_cast<unsigned*>(sq_ring + params.sq_off.head);
+		_sq_tail	= reinterpret_cast<unsigned*>(sq_ring + params.sq_off.tail);
+		_sq_local_tail = *_sq_tail;
+		_sq_mask	= *reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_mask);
+		_sq_entries	= *reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_entries);
+		_sq_array	= reinterpret_cast<unsigned*>(sq_ring + params.sq_off.array);
+
+		char* cq_ring = static_cast<char*>(_cq_ring);
+		_cq_head	= reinterpret_cast<unsigned*>(cq_ring + params.cq_off.head);
+		_cq_tail	= reinterpret_cast<unsigned*>(cq_ring + params.cq_off.tail);
+		_cq_mask	= *reinterpret_cast<unsigned*>(cq_ring + params.cq_off.ring_mask);
+		_cqes		= reinterpret_cast<io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+	}
+
+
+	template <std::size_t Entries, typename Log>
+	inline uring<Entries, Log>::~uring() noexcept {
+		::munmap(_sqes, _sqes_size);
+		if (_cq_ring != _sq_ring) {
+			::munmap(_cq_ring, _cq_ring_size);
+		}
+		::munmap(_sq_ring, _sq_ring_size);
+		::close(_handle);
+
+		if (_log != nullptr) {
+			_log->put_any(category::abc::uring, severity::abc::debug, 0x10370, "uring::~uring()");
+		}
+	}
+
+
+	template <std::size_t Entries, typename Log>
+	inline bool uring<Entries, Log>::prepare_send(socket::handle_t handle, const void* buffer, std::size_t size, std::uint64_t user_data) {
+		io_uring_sqe* sqe = get_sqe();
+		if (sqe == nullptr) {
+			return false;
+		}
+
+		sqe->opcode		= IORING_OP_SEND;
+		sqe->fd			= handle;
+		sqe->addr		= reinterpret_cast<std::uint64_t>(buffer);
+		sqe->len		= static_cast<std::uint32_t>(size);
+		sqe->msg_flags	= MSG_NOSIGNAL;
+		sqe->user_data	= user_data;
+
+		return true;
+	}
+
+
+	template <std::size_t Entries, typename Log>
+	inline bool uring<Entries, Log>::prepare_receive(socket::handle_t handle, void* buffer, std::size_t size, std::uint64_t user_data) {
+		io_uring_sqe* sqe = get_sqe();
+		if (sqe == nullptr) {
+			return false;
+		}
+
+		sqe->opcode		= IORING_OP_RECV;
+		sqe->fd			= handle;
+		sqe->addr		= reinterpret_cast<std::uint64_t>(buffer);
+		sqe->len		= static_cast<std::uint32_t>(size);
+		sqe->user_data	= user_data;
+
+		return true;
+	}
+
+
+	template <std::size_t Entries, typename Log>
+	inline bool uring<Entries, Log>::prepare_accept(socket::handle_t handle, std::uint64_t user_data) {
+		io_uring_sqe* sqe = get_sqe();
+		if (sqe == nullptr) {
+			return false;
+		}
+
+		sqe->opcode		= IORING_OP_ACCEPT;
+		sqe->fd			= handle;
+		sqe->user_data	= user_data;
+
+		return true;
+	}
+
+
+	template <std::size_t Entries, typename Log>
+	inline io_uring_sqe* uring<Entries, Log>::get_sqe() noexcept {
+		// The entry is filled in by the caller, so the tail is only published to the kernel by submit().
+		unsigned tail = _sq_local_tail;
+		unsigned head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+
+		if (tail - head >= _sq_entries) {
+			if (_log != nullptr) {
+				_log->put_any(category::abc::uring, severity::abc::optional, 0x10371, "uring::get_sqe() full");
+			}
+
+			return nullptr;
+		}
+
+		unsigned index = tail & _sq_mask;
+		io_uring_sqe* sqe = &_sqes[index];
+		std::memset(sqe, 0, sizeof(io_uring_sqe));
+
+		_sq_array[index] = index;
+		_sq_local_tail = tail + 1;
+		_pending_count++;
+
+		return sqe;
+	}
+
+
+	template <std::size_t Entries, typename Log>
+	inline std::size_t uring<Entries, Log>::submit(std::size_t wait_count) {
+		if (_log != nullptr) {
+			_log->put_any(category::abc::uring, severity::abc::debug, 0x10372, "uring::submit() >>> pending_count=%lu, wait_count=%lu", (std::uint32_t)_pending_count, (std::uint32_t)wait_count);
+		}
+
+		// The prepared entries are complete by now. The release store makes them visible before the kernel sees the new tail.
+		__atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+
+		unsigned flags = wait_count > 0 ? IORING_ENTER_GETEVENTS : 0;
+
+		long submitted_count;
+		do {
+			submitted_count = ::syscall(__NR_io_uring_enter, _handle, static_cast<unsigned>(_pending_count), static_cast<unsigned>(wait_count), flags, nullptr, 0);
+		}
+		while (submitted_count < 0 && errno == EINTR);
+
+		if (submitted_count < 0) {
+			throw exception<std::runtime_error, Log>("::io_uring_enter()", 0x10373, _log);
+		}
+
+		_pending_count -= submitted_count;
+
+		if (_log != nullptr) {
+			_log->put_any(category::abc::uring, severity::abc::debug, 0x10374, "uring::submit() <<< submitted_count=%lu", (std::uint32_t)submitted_count);
+		}
+
+		return submitted_count;
+	}
+
+
+	template <std::size_t Entries, typename Log>
+	inline bool uring<Entries, Log>::get_completion(uring_completion& completion) noexcept {
+		// This is the only consumer of the completion queue, so the head can be read plainly.
+		unsigned head = *_cq_head;
+		unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+
+		if (head == tail) {
+			return false;
+		}
+
+		const io_uring_cqe* cqe = &_cqes[head & _cq_mask];
+		completion.user_data	= cqe->user_data;
+		completion.result		= cqe->res;
+
+		__atomic_store_n(_cq_head, head + 1, __ATOMIC_RELEASE);
+
+		return true;
+	}
+
+
+	template <std::size_t Entries, typename Log>
+	inline std::size_t uring<Entries, Log>::pending_count() const noexcept {
+		return _pending_count;
+	}
+
+}
@@ -0,0 +1,98 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <linux/io_uring.h>
+
+#include "size.h"
+#include "socket.i.h"
+#include "log.i.h"
+
+
+namespace abc {
+
+	struct uring_completion {
+		std::uint64_t	user_data;
+		std::int32_t	result;
+	};
+
+
+	// --------------------------------------------------------------
+
+
+	// An io_uring instance created through raw syscalls. Operations are queued with prepare_*(),
+	// and are handed to the kernel in a batch by submit(). Not thread-safe.
+	// Sockets queue their own operations with _client_socket::prepare_send()/prepare_receive() and tcp_server_socket::prepare_accept().
+	template <std::size_t Entries = size::_64, typename Log = null_log>
+	class uring {
+	public:
+		uring(Log* log = nullptr);
+		uring(uring&& other) = delete;
+		uring(const uring& other) = delete;
+
+		~uring() noexcept;
+
+	public:
+		bool			prepare_send(socket::handle_t handle, const void* buffer, std::size_t size, std::uint64_t user_data);
+		bool			prepare_receive(socket::handle_t handle, void* buffer, std::size_t size, std::uint64_t user_data);
+		bool			prepare_accept(socket::handle_t handle, std::uint64_t user_data);
+
+		std::size_t		submit(std::size_t wait_count = 0);
+		bool			get_completion(uring_completion& completion) noexcept;
+
+		std::size_t		pending_count() const noexcept;
+
+	private:
+		io_uring_sqe*	get_sqe() noexcept;
+
+	private:
+		int				_handle;
+		void*			_sq_ring;
+		std::size_t		_sq_ring_size;
+		void*			_cq_ring;
+		std::size_t		_cq_ring_size;
+		io_uring_sqe*	_sqes;
+		std::size_t		_sqes_size;
+
+		unsigned*		_sq_head;
+		unsigned*		_sq_tail;
+		unsigned		_sq_local_tail;
+		unsigned		_sq_mask;
+		unsigned		_sq_entries;
+		unsigned*		_sq_array;
+
+		unsigned*		_cq_head;
+		unsigned*		_cq_tail;
+		unsigned		_cq_mask;
+		io_uring_cqe*	_cqes;
+
+		std::size_t		_pending_count;
+		Log*			_log;
+	};
+
+}
@@ -0,0 +1,88 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include "../src/socket.h"
+
+#include "connection_pool.h"
+
+
+namespace abc { namespace test { namespace connection_pool {
+
+	bool test_connection_pool_reuse(test_context<abc::test::log>& context) {
+		const char server_port[] = "31246";
+		bool passed = true;
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		abc::connection_pool<abc::test::log, 4> pool(2, std::chrono::seconds(60), context.log);
+
+		abc::tcp_client_socket<abc::test::log>* client1 = pool.acquire("localhost", server_port);
+		passed = context.are_equal(client1 != nullptr, true, 0x103d7, "%d") && passed;
+		abc::tcp_client_socket server1 = std::move(server.accept());
+
+		// A released connection is handed out again.
+		pool.release(client1);
+		abc::tcp_client_socket<abc::test::log>* client2 = pool.acquire("localhost", server_port);
+		passed = context.are_equal(client2 == client1, true, 0x103d8, "%d") && passed;
+
+		// A second connection to the same host is new.
+		abc::tcp_client_socket<abc::test::log>* client3 = pool.acquire("localhost", server_port);
+		passed = context.are_equal(client3 != nullptr && client3 != client1, true, 0x103d9, "%d") && passed;
+		abc::tcp_client_socket server3 = std::move(server.accept());
+
+		// A third one exceeds max_per_host.
+		abc::tcp_client_socket<abc::test::log>* client4 = pool.acquire("localhost", server_port);
+		passed = context.are_equal(client4 == nullptr, true, 0x103da, "%d") && passed;
+
+		pool.release(client3, false);
+		pool.release(client2);
+
+		// A connection that has something to read is not handed out.
+		char ch = 'x';
+		server1.send(&ch, sizeof(ch));
+		abc::tcp_client_socket<abc::test::log>* client5 = pool.acquire("localhost", server_port);
+		passed = context.are_equal(client5 != nullptr, true, 0x103db, "%d") && passed;
+
+		// Verify the new connection is alive.
+		abc::tcp_client_socket server5 = std::move(server.accept());
+		ch = 'y';
+		client5->send(&ch, sizeof(ch));
+		server5.receive(&ch, sizeof(ch));
+		passed = context.are_equal(ch, 'y', 0x103dc, "%c") && passed;
+
+		// Close the client side first to avoid TIME_WAIT on the server port.
+		client5->close();
+		pool.release(client5);
+
+		passed = context.are_equal(pool.hit_count(), (std::size_t)1, 0x103dd, "%zu") && passed;
+		passed = context.are_equal(pool.miss_count(), (std::size_t)3, 0x103de, "%zu") && passed;
+
+		return passed;
+	}
+
+}}}
@@ -0,0 +1,222 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include "coroutine.h"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <thread>
+#include <cstring>
+#include <optional>
+#include <exception>
+
+#include "../src/buffer_streambuf.h"
+#include "../src/http.h"
+
+#include "heap.h"
+
+
+namespace abc { namespace test { namespace coroutine {
+
+	using reactor_t = abc::reactor<abc::size::_16, abc::test::log>;
+	using frame_pool_t = abc::frame_pool<abc::size::k2, 1>;
+
+
+	abc::task wait_forever(abc::frame_allocator& /*frame_allocator*/) {
+		co_await std::suspend_always { };
+	}
+
+
+	bool test_coroutine_frame_pool(test_context<abc::test::log>& context) {
+		bool passed = true;
+
+		frame_pool_t frame_pool;
+
+		// The first frame takes the only block. The second coroutine doesn't start.
+		abc::task task1 = wait_forever(frame_pool);
+		passed = context.are_equal(task1.is_started(), true, 0x1043b, "%d") && passed;
+		passed = context.are_equal(frame_pool.free_count(), (std::size_t)0, 0x1043c, "%zu") && passed;
+
+		abc::task task2 = wait_forever(frame_pool);
+		passed = context.are_equal(task2.is_started(), false, 0x1043d, "%d") && passed;
+
+		return passed;
+	}
+
+
+	abc::task serve(abc::frame_allocator& /*frame_allocator*/, reactor_t& reactor, abc::tcp_server_socket<abc::test::log>& listener, test_context<abc::test::log>& context, bool& passed, bool& is_done) {
+		const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+
+		abc::tcp_client_socket<abc::test::log> client = co_await abc::async_accept(reactor, listener);
+
+		// The head arrives in pieces.
+		char buffer[abc::size::_256];
+		abc::request_head head = co_await abc::async_receive_request_head(reactor, client, buffer, sizeof(buffer));
+		passed = context.are_equal(head.head_size > 0, true, 0x1043e, "%d") && passed;
+
+		// The complete head is parsed without blocking.
+		abc::buffer_streambuf sb(buffer, 0, head.head_size, nullptr, 0, 0);
+		abc::http_request_istream<abc::test::log> request(&sb, context.log);
+
+		char method[abc::size::_16];
+		request.get_method(method, sizeof(method));
+		passed = context.are_equal(method, "GET", 0x1043f) && passed;
+
+		char resource[abc::size::_64];
+		request.get_resource(resource, sizeof(resource));
+		passed = context.are_equal(resource, "/coroutine", 0x10440) && passed;
+
+		socket::status_t status = co_await abc::async_send(reactor, client, response, std::strlen(response));
+		passed = context.are_equal(status, socket::status::done, 0x10441, "%u") && passed;
+
+		// Wait for the client to close the connection.
+		std::size_t received_size = co_await abc::async_receive(reactor, client, buffer, sizeof(buffer));
+		passed = context.are_equal(received_size, (std::size_t)0, 0x10442, "%zu") && passed;
+
+		is_done = true;
+	}
+
+
+	bool test_coroutine_http_exchange(test_context<abc::test::log>& context) {
+		const char server_port[] = "31251";
+		const char request_part1[] = "GET /corout";
+		const char request_part2[] = "ine HTTP/1.1\r\nHost: localhost\r\n\r\n";
+		const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+		bool passed = true;
+
+		abc::tcp_server_socket<abc::test::log> listener(context.log);
+		listener.bind(server_port);
+		listener.listen(5);
+		listener.set_blocking(false);
+
+		reactor_t reactor(context.log);
+		frame_pool_t frame_pool;
+
+		// The coroutine runs until it has to wait for the client.
+		bool is_done = false;
+		std::optional<abc::task> task;
+		task.emplace(serve(frame_pool, reactor, listener, context, passed, is_done));
+		passed = context.are_equal(task->is_started(), true, 0x10443, "%d") && passed;
+
+		std::thread client_thread([&passed, &context, server_port, request_part1, request_part2, response] () {
+			try {
+				abc::tcp_client_socket<abc::test::log> client(context.log);
+				client.connect("localhost", server_port);
+
+				client.send(request_part1, std::strlen(request_part1));
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				client.send(request_part2, std::strlen(request_part2));
+
+				char content[sizeof(response)];
+				client.receive(content, sizeof(content) - 1);
+				content[sizeof(content) - 1] = '\0';
+				passed = context.are_equal(content, response, 0x10444) && passed;
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x10445, "client: EXCEPTION: %s", ex.what());
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x10446) && passed; // Lambda closure
+
+		// The coroutine is resumed from the reactor.
+		while (!is_done) {
+			reactor.run_once(100);
+		}
+
+		client_thread.join();
+
+		passed = context.are_equal(task->is_done(), true, 0x104c6, "%d") && passed;
+		passed = context.are_equal(task->error() == nullptr, true, 0x104c7, "%d") && passed;
+
+		// Once the task is gone, the frame is returned to the pool.
+		task.reset();
+		passed = context.are_equal(frame_pool.free_count(), (std::size_t)1, 0x10447, "%zu") && passed;
+
+		return passed;
+	}
+
+
+	struct suspend_and_save {
+		std::coroutine_handle<>&	coroutine;
+
+		bool	await_ready() const noexcept { return false; }
+		void	await_suspend(std::coroutine_handle<> suspended) noexcept { coroutine = suspended; }
+		void	await_resume() const noexcept { }
+	};
+
+
+	// Unlike std::runtime_error, it doesn't allocate its message on the heap.
+	struct resumed_error : std::exception {
+		virtual const char* what() const noexcept override { return "resumed"; }
+	};
+
+
+	abc::task throw_when_resumed(abc::frame_allocator& /*frame_allocator*/, std::coroutine_handle<>& coroutine) {
+		co_await suspend_and_save { coroutine };
+		throw resumed_error();
+	}
+
+
+	bool test_coroutine_exception(test_context<abc::test::log>& context) {
+		bool passed = true;
+
+		frame_pool_t frame_pool;
+		std::coroutine_handle<> coroutine;
+
+		// The exception is kept until the task is destroyed.
+		std::optional<abc::task> task;
+		task.emplace(throw_when_resumed(frame_pool, coroutine));
+		passed = context.are_equal(task->is_done(), false, 0x104c8, "%d") && passed;
+		passed = context.are_equal(task->error() == nullptr, true, 0x104c9, "%d") && passed;
+
+		coroutine.resume();
+		passed = context.are_equal(task->is_done(), true, 0x104ca, "%d") && passed;
+
+		try {
+			std::rethrow_exception(task->error());
+		}
+		catch (const resumed_error& ex) {
+			passed = context.are_equal(ex.what(), "resumed", 0x104cb) && passed;
+		}
+
+		passed = context.are_equal(frame_pool.free_count(), (std::size_t)0, 0x104cc, "%zu") && passed;
+		task.reset();
+		passed = context.are_equal(frame_pool.free_count(), (std::size_t)1, 0x104cd, "%zu") && passed;
+
+		// A task that is destroyed first leaves the frame to the coroutine.
+		task.emplace(throw_when_resumed(frame_pool, coroutine));
+		task.reset();
+		passed = context.are_equal(frame_pool.free_count(), (std::size_t)0, 0x104ce, "%zu") && passed;
+
+		coroutine.resume();
+		passed = context.are_equal(frame_pool.free_count(), (std::size_t)1, 0x104cf, "%zu") && passed;
+
+		return passed;
+	}
+
+}}}
+
+#endif
@@ -0,0 +1,119 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <thread>
+#include <cstring>
+#include <sys/socket.h>
+
+#include "endpoint.h"
+#include "heap.h"
+
+
+namespace abc { namespace test { namespace endpoint {
+
+	// Exposes process_request(), so that a test can serve a single connection on its own thread.
+	class test_endpoint : public abc::endpoint<abc::endpoint_limits, abc::test::log> {
+		using base = abc::endpoint<abc::endpoint_limits, abc::test::log>;
+
+	public:
+		test_endpoint(abc::endpoint_config* config, abc::test::log* log)
+			: base(config, log) {
+		}
+
+	public:
+		using base::process_request;
+
+	protected:
+		virtual void process_rest_request(abc::http_server_stream<abc::test::log>& http, const char* method, const char* resource) override {
+			if (std::strcmp(resource, "/broken") != 0) {
+				send_simple_response(http, abc::status_code::OK, abc::reason_phrase::OK, abc::content_type::text, "second", 0x104d8);
+				return;
+			}
+
+			// A control character is not a valid header value. The stream goes bad, and the rest of the response is skipped.
+			http.put_protocol(abc::protocol::HTTP_11);
+			http.put_status_code(abc::status_code::OK);
+			http.put_reason_phrase(abc::reason_phrase::OK);
+			http.put_header_name(abc::header::Connection);
+			http.put_header_value("keep\x01" "alive");
+			http.put_header_name(abc::header::Content_Length);
+			http.put_header_value("5");
+			http.end_headers();
+			http.put_body("first");
+		}
+	};
+
+
+	bool test_endpoint_keep_alive_broken_response(test_context<abc::test::log>& context) {
+		const char server_port[] = "31255";
+		const char requests[] =
+			"GET /broken HTTP/1.1\r\n"
+			"\r\n"
+			"GET /second HTTP/1.1\r\n"
+			"\r\n";
+		bool passed = true;
+
+		abc::endpoint_config config(server_port, 5, "", "/files/");
+		test_endpoint endpoint(&config, context.log);
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x104d9, 2) && passed; // Promise state and result
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		std::thread client_thread([&passed, &context, server_port, requests] () {
+			try {
+				abc::tcp_client_socket client(context.log);
+				client.connect("localhost", server_port);
+				client.set_idle_timeout(std::chrono::seconds(5));
+
+				// Both requests go in one segment. Shutting down the sending side first keeps TIME_WAIT off the server port.
+				client.send(requests, std::strlen(requests));
+				::shutdown(client.handle(), SHUT_WR);
+
+				char response[abc::size::k1 + 1];
+				std::size_t response_size = 0;
+				for (std::size_t size = 1; size > 0 && response_size < sizeof(response) - 1; response_size += size) {
+					size = client.receive_some(response + response_size, sizeof(response) - 1 - response_size);
+				}
+				response[response_size] = '\0';
+
+				// The connection must be closed after the broken response, so the second request is never answered.
+				passed = context.are_equal(std::strstr(response, "second") == nullptr, true, 0x104da, "%d") && passed;
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x104db, "client: EXCEPTION: %s", ex.what());
+				passed = false;
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x104dc) && passed; // Lambda closure
+
+		endpoint.process_request(server.accept());
+
+		client_thread.join();
+		return passed;
+	}
+
+}}}
@@ -65,8 +65,8 @@ namespace abc { namespace test { namespace heap {
 	}
 
 
-	bool ignore_heap_allocation(test_context<abc::test::log>& context, tag_t tag) {
-		instance_unaligned_throw_count--;
+	bool ignore_heap_allocation(test_context<abc::test::log>& context, tag_t tag, counter_t count) {
+		instance_unaligned_throw_count -= count;
 
 		return verify_heap_allocation(context, tag);
 	}
@@ -35,7 +35,7 @@ namespace abc { namespace test { namespace heap {
 
 	bool start_heap_allocation(test_context<abc::test::log>& context);
 	bool test_heap_allocation(test_context<abc::test::log>& context);
-	bool ignore_heap_allocation(test_context<abc::test::log>& context, tag_t tag);
+	bool ignore_heap_allocation(test_context<abc::test::log>& context, tag_t tag, std::int32_t count = 1);
 
 }}}
 
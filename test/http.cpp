@@ -34,6 +34,8 @@ namespace abc { namespace test { namespace http {
 	template <typename HttpStream>
 	static bool verify_binary(test_context<abc::test::log>& context, const void* actual, const void* expected, std::size_t size, const HttpStream& stream, tag_t tag);
 
+	static bool verify_span(test_context<abc::test::log>& context, abc::char_span actual, const char* expected, tag_t tag);
+
 
 	bool test_http_request_istream_extraspaces(test_context<abc::test::log>& context) {
 		char content[] =
@@ -661,6 +663,485 @@ namespace abc { namespace test { namespace http {
 	// --------------------------------------------------------------
 
 
+	// Counts how many times the stream writes to it, so a test can tell whether the head went out in one piece.
+	class write_counting_streambuf : public abc::buffer_streambuf {
+		using base = abc::buffer_streambuf;
+
+	public:
+		write_counting_streambuf(char* buffer, std::size_t size)
+			: base(nullptr, 0, 0, buffer, 0, size)
+			, write_count(0) {
+		}
+
+	public:
+		std::size_t write_count;
+
+	protected:
+		virtual std::streamsize xsputn(const char* s, std::streamsize count) override {
+			write_count++;
+			return base::xsputn(s, count);
+		}
+
+		virtual int_type overflow(int_type ch) override {
+			write_count++;
+			return base::overflow(ch);
+		}
+	};
+
+
+	bool test_http_response_ostream_head_buffer(test_context<abc::test::log>& context) {
+		const char expected[] =
+			"HTTP/1.1 200 OK\r\n"
+			"Content-Type: text/plain\r\n"
+			"List: foo bar foobar\r\n"
+			"\r\n"
+			"First line\r\n";
+
+		char actual[1024 + 1] = { };
+		char head[256];
+
+		write_counting_streambuf sb(actual, sizeof(actual));
+
+		abc::http_response_ostream<abc::test::log> ostream(&sb, context.log);
+		ostream.set_head_buffer(head, sizeof(head));
+
+		bool passed = true;
+
+		ostream.put_protocol("HTTP/1.1");
+		ostream.put_status_code("200");
+		ostream.put_reason_phrase("OK");
+		ostream.put_header_name("Content-Type");
+		ostream.put_header_value("text/plain");
+		ostream.put_header_name("List");
+		ostream.put_header_value("foo    bar\t\t\tfoobar   \t  \t \t ");
+		passed = verify_stream(context, ostream, 0x10498) && passed;
+
+		// Nothing should have reached the streambuf before the end of the head.
+		passed = context.are_equal(sb.write_count, (std::size_t)0, 0x10499, "%zu") && passed;
+		passed = context.are_equal(actual, "", 0x1049a) && passed;
+
+		ostream.end_headers();
+		passed = verify_stream(context, ostream, 0x1049b) && passed;
+
+		// The whole head should have been written at once.
+		passed = context.are_equal(sb.write_count, (std::size_t)1, 0x1049c, "%zu") && passed;
+
+		ostream.put_body("First line\r\n");
+		passed = verify_stream(context, ostream, 0x1049d) && passed;
+
+		passed = context.are_equal(actual, expected, std::strlen(expected), 0x1049e) && passed;
+
+		// A head that doesn't fit in the head buffer makes the stream bad.
+		abc::buffer_streambuf sb_small(nullptr, 0, 0, actual, 0, sizeof(actual));
+		abc::http_response_ostream<abc::test::log> ostream_small(&sb_small, context.log);
+		ostream_small.set_head_buffer(head, 16);
+
+		ostream_small.put_protocol("HTTP/1.1");
+		ostream_small.put_status_code("200");
+		ostream_small.put_reason_phrase("OK");
+		passed = context.are_equal(ostream_small.bad(), true, 0x1049f, "%d") && passed;
+
+		return passed;
+	}
+
+
+	bool test_http_server_stream_keep_alive(test_context<abc::test::log>& context) {
+		char content[] =
+			"GET /first HTTP/1.1\r\n"
+			"Host: a.com\r\n"
+			"\r\n"
+			"GET /second HTTP/1.1\r\n"
+			"\r\n";
+
+		const char expected[] =
+			"HTTP/1.1 200 OK\r\n"
+			"Connection: keep-alive\r\n"
+			"\r\n"
+			"HTTP/1.1 404 Not Found\r\n"
+			"Connection: close\r\n"
+			"\r\n";
+
+		char actual[1024 + 1] = { };
+
+		abc::buffer_streambuf sb(content, 0, std::strlen(content), actual, 0, sizeof(actual));
+
+		abc::http_server_stream<abc::test::log> stream(&sb, context.log);
+		abc::http_request_istream<abc::test::log>& istream = stream;
+
+		char buffer[101];
+		bool passed = true;
+
+		// First request
+		stream.set_keep_alive(true);
+
+		stream.get_method(buffer, sizeof(buffer));
+		stream.get_resource(buffer, sizeof(buffer));
+		passed = verify_string(context, buffer, "/first", istream, 0x104a3) && passed;
+
+		stream.get_protocol(buffer, sizeof(buffer));
+		stream.get_header_name(buffer, sizeof(buffer));
+		stream.get_header_value(buffer, sizeof(buffer));
+		stream.get_header_name(buffer, sizeof(buffer));
+		passed = verify_string(context, buffer, "", istream, 0x104a4) && passed;
+
+		stream.put_protocol("HTTP/1.1");
+		stream.put_status_code("200");
+		stream.put_reason_phrase("OK");
+		stream.put_header_name("Connection");
+		stream.put_header_value(stream.keep_alive() ? "keep-alive" : "close");
+		stream.end_headers();
+
+		// Second request on the same stream
+		stream.reset();
+		stream.set_keep_alive(false);
+
+		stream.get_method(buffer, sizeof(buffer));
+		passed = verify_string(context, buffer, "GET", istream, 0x104a5) && passed;
+
+		stream.get_resource(buffer, sizeof(buffer));
+		passed = verify_string(context, buffer, "/second", istream, 0x104a6) && passed;
+
+		stream.get_protocol(buffer, sizeof(buffer));
+		stream.get_header_name(buffer, sizeof(buffer));
+		passed = verify_string(context, buffer, "", istream, 0x104a7) && passed;
+
+		stream.put_protocol("HTTP/1.1");
+		stream.put_status_code("404");
+		stream.put_reason_phrase("Not Found");
+		stream.put_header_name("Connection");
+		stream.put_header_value(stream.keep_alive() ? "keep-alive" : "close");
+		stream.end_headers();
+
+		passed = context.are_equal(actual, expected, 0x104a8) && passed;
+
+		return passed;
+	}
+
+
+	bool test_http_response_ostream_chunked(test_context<abc::test::log>& context) {
+		const char expected[] =
+			"HTTP/1.1 200 OK\r\n"
+			"Transfer-Encoding: chunked\r\n"
+			"\r\n"
+			"5\r\n"
+			"Hello\r\n"
+			"1a\r\n"
+			"abcdefghijklmnopqrstuvwxyz\r\n"
+			"0\r\n"
+			"Expires: never\r\n"
+			"\r\n";
+
+		char actual[1024 + 1] = { };
+
+		abc::buffer_streambuf sb(nullptr, 0, 0, actual, 0, sizeof(actual));
+
+		abc::http_response_ostream<abc::test::log> ostream(&sb, context.log);
+
+		bool passed = true;
+
+		ostream.put_protocol("HTTP/1.1");
+		ostream.put_status_code("200");
+		ostream.put_reason_phrase("OK");
+		ostream.put_header_name("Transfer-Encoding");
+		ostream.put_header_value("chunked");
+		ostream.end_headers();
+
+		ostream.put_chunk("Hello");
+		passed = verify_stream(context, ostream, 0x104ae) && passed;
+
+		// An empty chunk would end the body, so it is skipped.
+		ostream.put_chunk("");
+		passed = verify_stream(context, ostream, 0x104af) && passed;
+
+		ostream.put_chunk("abcdefghijklmnopqrstuvwxyz");
+		passed = verify_stream(context, ostream, 0x104b0) && passed;
+
+		ostream.end_chunks();
+		ostream.put_header_name("Expires");
+		ostream.put_header_value("never");
+		ostream.end_headers();
+		passed = verify_stream(context, ostream, 0x104b1) && passed;
+
+		passed = context.are_equal(actual, expected, 0x104b2) && passed;
+
+		return passed;
+	}
+
+
+	// Unlike std::runtime_error, it doesn't allocate its message on the heap.
+	struct receive_error : std::exception {
+		virtual const char* what() const noexcept override { return "receive failed"; }
+	};
+
+
+	// Fails to refill its get area like a socket_streambuf whose peer has reset the connection.
+	class failing_span_streambuf : public abc::span_streambuf {
+	protected:
+		virtual int_type underflow() override { throw receive_error(); }
+	};
+
+
+	bool test_http_request_istream_receive_error(test_context<abc::test::log>& context) {
+		failing_span_streambuf sb;
+
+		abc::http_request_istream<abc::test::log> istream(&sb, context.log);
+
+		char buffer[101];
+		bool passed = true;
+
+		// The exception doesn't escape the stream. The stream goes bad instead.
+		bool is_thrown = false;
+		try {
+			istream.get_method(buffer, sizeof(buffer));
+		}
+		catch (const receive_error&) {
+			is_thrown = true;
+		}
+
+		passed = context.are_equal(is_thrown, false, 0x104d1, "%d") && passed;
+		passed = context.are_equal(istream.bad(), true, 0x104d2, "%d") && passed;
+
+		return passed;
+	}
+
+
+	bool test_http_request_istream_chunked(test_context<abc::test::log>& context) {
+		char content[] =
+			"POST /a HTTP/1.1\r\n"
+			"Transfer-Encoding: chunked\r\n"
+			"\r\n"
+			"5;name=value\r\n"
+			"Hello\r\n"
+			"1A\r\n"
+			"abcdefghijklmnopqrstuvwxyz\r\n"
+			"0\r\n"
+			"Expires: never\r\n"
+			"\r\n";
+
+		abc::buffer_streambuf sb(content, 0, std::strlen(content), nullptr, 0, 0);
+
+		abc::http_request_istream<abc::test::log> istream(&sb, context.log);
+
+		char buffer[101];
+		bool passed = true;
+
+		istream.get_method(buffer, sizeof(buffer));
+		istream.get_resource(buffer, sizeof(buffer));
+		istream.get_protocol(buffer, sizeof(buffer));
+
+		istream.get_header_name(buffer, sizeof(buffer));
+		istream.get_header_value(buffer, sizeof(buffer));
+		passed = verify_string(context, buffer, "chunked", istream, 0x104b3) && passed;
+
+		istream.get_header_name(buffer, sizeof(buffer));
+		passed = verify_string(context, buffer, "", istream, 0x104b4) && passed;
+		passed = context.are_equal(istream.is_chunked(), true, 0x104b5, "%d") && passed;
+
+		// Read the body in pieces that don't line up with the chunks.
+		char body[101] = { };
+		std::size_t body_size = 0;
+		const std::size_t piece_size = 7;
+
+		while (true) {
+			istream.get_body(body + body_size, piece_size);
+			if (istream.gcount() == 0) {
+				break;
+			}
+
+			body_size += istream.gcount();
+		}
+
+		passed = verify_stream(context, istream, 0, 0x104b6) && passed;
+		passed = context.are_equal(body, "Helloabcdefghijklmnopqrstuvwxyz", 0x104b7) && passed;
+
+		// The trailers are read like headers.
+		istream.get_header_name(buffer, sizeof(buffer));
+		passed = verify_string(context, buffer, "Expires", istream, 0x104b8) && passed;
+
+		istream.get_header_value(buffer, sizeof(buffer));
+		passed = verify_string(context, buffer, "never", istream, 0x104b9) && passed;
+
+		istream.get_header_name(buffer, sizeof(buffer));
+		passed = verify_string(context, buffer, "", istream, 0x104ba) && passed;
+
+		// The body is over.
+		istream.get_body(buffer, sizeof(buffer));
+		passed = context.are_equal(istream.gcount(), (std::size_t)0, 0x104bb, "%zu") && passed;
+
+		return passed;
+	}
+
+
+	bool test_http_chunk_streambuf_json(test_context<abc::test::log>& context) {
+		const char expected_body[] =
+			"{"
+				"\"a\":[true,false,null],"
+				"\"b\":\"The size of this body is not known up front.\""
+			"}";
+
+		char actual[1024 + 1] = { };
+
+		abc::buffer_streambuf sb(nullptr, 0, 0, actual, 0, sizeof(actual));
+
+		abc::http_response_ostream<abc::test::log> ostream(&sb, context.log);
+
+		bool passed = true;
+
+		ostream.put_protocol("HTTP/1.1");
+		ostream.put_status_code("200");
+		ostream.put_reason_phrase("OK");
+		ostream.put_header_name("Transfer-Encoding");
+		ostream.put_header_value("chunked");
+		ostream.end_headers();
+
+		// The JSON goes out in chunks of up to 16 bytes as it is written.
+		abc::http_chunk_streambuf<abc::size::_16, abc::test::log> chunk_sb(&ostream);
+		abc::json_ostream<abc::size::_64, abc::test::log> json(&chunk_sb, context.log);
+
+		json.put_begin_object();
+			json.put_property("a");
+			json.put_begin_array();
+				json.put_boolean(true);
+				json.put_boolean(false);
+				json.put_null();
+			json.put_end_array();
+			json.put_property("b");
+			json.put_string("The size of this body is not known up front.");
+		json.put_end_object();
+		passed = verify_stream(context, json, 0x104bc) && passed;
+
+		chunk_sb.end_chunks();
+		ostream.end_headers();
+		passed = verify_stream(context, ostream, 0x104bd) && passed;
+
+		// Read the response back.
+		abc::buffer_streambuf in_sb(actual, 0, std::strlen(actual), nullptr, 0, 0);
+		abc::http_response_istream<abc::test::log> istream(&in_sb, context.log);
+
+		char buffer[101];
+
+		istream.get_protocol(buffer, sizeof(buffer));
+		istream.get_status_code(buffer, sizeof(buffer));
+		istream.get_reason_phrase(buffer, sizeof(buffer));
+		istream.get_header_name(buffer, sizeof(buffer));
+		istream.get_header_value(buffer, sizeof(buffer));
+		istream.get_header_name(buffer, sizeof(buffer));
+
+		char body[1024 + 1] = { };
+		istream.get_body(body, sizeof(body) - 1);
+		passed = verify_string(context, body, expected_body, istream, 0x104be) && passed;
+
+		istream.get_body(body, sizeof(body) - 1);
+		passed = context.are_equal(istream.gcount(), (std::size_t)0, 0x104bf, "%zu") && passed;
+
+		return passed;
+	}
+
+
+	bool test_http_request_parser_realworld_01(test_context<abc::test::log>& context) {
+		char content[] =
+			"GET https://en.cppreference.com/w/cpp/io/basic_streambuf HTTP/1.1\r\n"
+			"Host: en.cppreference.com\r\n"
+			"User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:76.0) Gecko/20100101 Firefox/76.0\r\n"
+			"Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;q=0.8\r\n"
+			"Accept-Language: en-US,en;q=0.5\r\n"
+			"Accept-Encoding: gzip, deflate, br\r\n"
+			"Connection: keep-alive\r\n"
+			"Upgrade-Insecure-Requests: 1\r\n"
+			"Cache-Control: max-age=0\r\n"
+			"\r\n"
+			"body";
+
+		abc::http_request_parser<abc::size::_16, abc::test::log> parser(context.log);
+		bool passed = true;
+
+		passed = context.are_equal(parser.parse(content, std::strlen(content)), abc::http::parse_status::done, 0x10474, "%u") && passed;
+		passed = context.are_equal(parser.head_size(), std::strlen(content) - 4, 0x10475, "%zu") && passed;
+
+		// The views point into the content.
+		passed = context.are_equal(parser.method().data == content, true, 0x10476, "%d") && passed;
+		passed = verify_span(context, parser.method(), "GET", 0x10477) && passed;
+		passed = verify_span(context, parser.resource(), "https://en.cppreference.com/w/cpp/io/basic_streambuf", 0x10478) && passed;
+		passed = verify_span(context, parser.protocol(), "HTTP/1.1", 0x10479) && passed;
+
+		passed = context.are_equal(parser.header_count(), (std::size_t)8, 0x1047a, "%zu") && passed;
+		passed = verify_span(context, parser.header(1).name, "User-Agent", 0x1047b) && passed;
+		passed = verify_span(context, parser.header(1).value, "Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:76.0) Gecko/20100101 Firefox/76.0", 0x1047c) && passed;
+		passed = verify_span(context, parser.find_header("connection"), "keep-alive", 0x1047d) && passed;
+		passed = context.are_equal(parser.find_header("Cookie").data == nullptr, true, 0x1047e, "%d") && passed;
+
+		return passed;
+	}
+
+
+	bool test_http_request_parser_incremental(test_context<abc::test::log>& context) {
+		char content[] =
+			"GET   http://a.com/b?c=d    HTTP/12.345  \r\n"
+			"Name:Value\r\n"
+			"Multi_Word-Name:  Value  with   spaces   inside \t \r\n"
+			"Trailing-Spaces:  3 spaces   \r\n"
+			"\r\n";
+		std::size_t content_size = std::strlen(content);
+
+		abc::http_request_parser<abc::size::_16, abc::test::log> parser(context.log);
+		bool passed = true;
+
+		// The content arrives one byte at a time.
+		for (std::size_t size = 1; size < content_size; size++) {
+			passed = context.are_equal(parser.parse(content, size), abc::http::parse_status::need_more, 0x1047f, "%u") && passed;
+		}
+		passed = context.are_equal(parser.parse(content, content_size), abc::http::parse_status::done, 0x10480, "%u") && passed;
+		passed = context.are_equal(parser.head_size(), content_size, 0x10481, "%zu") && passed;
+
+		passed = verify_span(context, parser.method(), "GET", 0x10482) && passed;
+		passed = verify_span(context, parser.resource(), "http://a.com/b?c=d", 0x10483) && passed;
+		passed = verify_span(context, parser.protocol(), "HTTP/12.345", 0x10484) && passed;
+
+		passed = context.are_equal(parser.header_count(), (std::size_t)3, 0x10485, "%zu") && passed;
+		passed = verify_span(context, parser.header(0).name, "Name", 0x10486) && passed;
+		passed = verify_span(context, parser.header(0).value, "Value", 0x10487) && passed;
+
+		// Values are trimmed, but not collapsed.
+		passed = verify_span(context, parser.header(1).value, "Value  with   spaces   inside", 0x10488) && passed;
+		passed = verify_span(context, parser.header(2).name, "Trailing-Spaces", 0x10489) && passed;
+		passed = verify_span(context, parser.find_header("trailing-spaces"), "3 spaces", 0x1048b) && passed;
+
+		return passed;
+	}
+
+
+	bool test_http_request_parser_bad(test_context<abc::test::log>& context) {
+		const char* contents[] = {
+			"GET /\r\n\r\n",
+			"GET / FTP/1.1\r\n\r\n",
+			"GET / HTTP/1.1\n\r\n",
+			"GET / HTTP/1.1\r\nName Value\r\n\r\n",
+			"GET / HTTP/1.1\r\n Value\r\n\r\n",
+			"GET / HTTP/1.1\r\nName: Bad\x01Value\r\n\r\n",
+			"GET / HTTP/1.1\r\nA: 1\r\nB: 2\r\nC: 3\r\n\r\n",
+
+			// A space before the ':', and a value folded onto the next line, could be framed differently by a proxy.
+			"GET / HTTP/1.1\r\nContent-Length : 5\r\n\r\n",
+			"GET / HTTP/1.1\r\nContent-Length\t: 5\r\n\r\n",
+			"GET / HTTP/1.1\r\nName: First line\r\n Second line\r\n\r\n",
+			"GET / HTTP/1.1\r\nName: First line\r\n\tSecond line\r\n\r\n",
+		};
+		bool passed = true;
+
+		abc::http_request_parser<2, abc::test::log> parser(context.log);
+
+		for (const char* content : contents) {
+			parser.reset();
+			passed = context.are_equal(parser.parse(content, std::strlen(content)), abc::http::parse_status::bad, 0x1048c, "%u") && passed;
+		}
+
+		return passed;
+	}
+
+
+	// --------------------------------------------------------------
+
+
 	template <typename HttpStream>
 	static bool verify_string(test_context<abc::test::log>& context, const char* actual, const char* expected, const HttpStream& stream, tag_t tag) {
 		bool passed = true;
@@ -682,5 +1163,16 @@ namespace abc { namespace test { namespace http {
 		return passed;
 	}
 
+
+	static bool verify_span(test_context<abc::test::log>& context, abc::char_span actual, const char* expected, tag_t tag) {
+		std::size_t expected_size = std::strlen(expected);
+		bool passed = true;
+
+		passed = context.are_equal(actual.size, expected_size, tag, "%zu") && passed;
+		passed = passed && context.are_equal(actual.data, expected, expected_size, tag);
+
+		return passed;
+	}
+
 }}}
 
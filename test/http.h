@@ -26,6 +26,7 @@ SOFTWARE.
 #pragma once
 
 #include "../src/http.h"
+#include "../src/json.h"
 
 #include "test.h"
 #include "stream.h"
@@ -47,6 +48,18 @@ namespace abc { namespace test { namespace http {
 
 	bool test_http_response_ostream_bodytext(test_context<abc::test::log>& context);
 	bool test_http_response_ostream_bodybinary(test_context<abc::test::log>& context);
+	bool test_http_response_ostream_head_buffer(test_context<abc::test::log>& context);
+
+	bool test_http_server_stream_keep_alive(test_context<abc::test::log>& context);
+
+	bool test_http_response_ostream_chunked(test_context<abc::test::log>& context);
+	bool test_http_request_istream_chunked(test_context<abc::test::log>& context);
+	bool test_http_request_istream_receive_error(test_context<abc::test::log>& context);
+	bool test_http_chunk_streambuf_json(test_context<abc::test::log>& context);
+
+	bool test_http_request_parser_realworld_01(test_context<abc::test::log>& context);
+	bool test_http_request_parser_incremental(test_context<abc::test::log>& context);
+	bool test_http_request_parser_bad(test_context<abc::test::log>& context);
 
 }}}
 
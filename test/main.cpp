@@ -31,6 +31,15 @@ SOFTWARE.
 #include "streambuf.h"
 #include "table.h"
 #include "socket.h"
+#include "reactor.h"
+#include "connection_pool.h"
+#include "endpoint.h"
+#include "queue.h"
+#include "ring_buffer.h"
+#include "scan.h"
+#include "send_queue.h"
+#include "timer_wheel.h"
+#include "coroutine.h"
 #include "http.h"
 #include "json.h"
 #include "heap.h"
@@ -62,6 +71,7 @@ int main() {
 			{ "streambuf", {
 				{ "test_buffer_streambuf_1_char",					abc::test::streambuf::test_buffer_streambuf_1_char },
 				{ "test_buffer_streambuf_N_chars",					abc::test::streambuf::test_buffer_streambuf_N_chars },
+				{ "test_buffer_streambuf_span",						abc::test::streambuf::test_buffer_streambuf_span },
 			} },
 			{ "table", {
 				{ "test_table_line_debug",							abc::test::table::test_table_line_debug },
@@ -79,6 +89,15 @@ int main() {
 				{ "test_http_response_istream_realworld_01",		abc::test::http::test_http_response_istream_realworld_01 },
 				{ "test_http_response_istream_realworld_02",		abc::test::http::test_http_response_istream_realworld_02 },
 				{ "test_http_response_ostream_bodytext",			abc::test::http::test_http_response_ostream_bodytext },
+				{ "test_http_response_ostream_head_buffer",			abc::test::http::test_http_response_ostream_head_buffer },
+				{ "test_http_server_stream_keep_alive",				abc::test::http::test_http_server_stream_keep_alive },
+				{ "test_http_response_ostream_chunked",				abc::test::http::test_http_response_ostream_chunked },
+				{ "test_http_request_istream_chunked",				abc::test::http::test_http_request_istream_chunked },
+				{ "test_http_request_istream_receive_error",		abc::test::http::test_http_request_istream_receive_error },
+				{ "test_http_chunk_streambuf_json",					abc::test::http::test_http_chunk_streambuf_json },
+				{ "test_http_request_parser_realworld_01",			abc::test::http::test_http_request_parser_realworld_01 },
+				{ "test_http_request_parser_incremental",			abc::test::http::test_http_request_parser_incremental },
+				{ "test_http_request_parser_bad",					abc::test::http::test_http_request_parser_bad },
 			} },
 			{ "json", {
 				{ "test_json_istream_null",							abc::test::json::test_json_istream_null },
@@ -121,11 +140,61 @@ int main() {
 			} },
 			{ "socket", {
 				{ "test_udp_sync_socket",							abc::test::socket::test_udp_sync_socket },
+				{ "test_udp_batch_socket",							abc::test::socket::test_udp_batch_socket },
+				{ "test_udp_multicast_socket",						abc::test::socket::test_udp_multicast_socket },
 				{ "test_tcp_sync_socket",							abc::test::socket::test_tcp_sync_socket },
+				{ "test_tcp_uring_socket",							abc::test::socket::test_tcp_uring_socket },
+				{ "test_tcp_iovec_socket",							abc::test::socket::test_tcp_iovec_socket },
+				{ "test_tcp_deadline_socket",						abc::test::socket::test_tcp_deadline_socket },
+				{ "test_socket_address_cache",						abc::test::socket::test_socket_address_cache },
+				{ "test_tcp_accept_all_socket",						abc::test::socket::test_tcp_accept_all_socket },
+				{ "test_tcp_socket_stats",							abc::test::socket::test_tcp_socket_stats },
+				{ "test_local_stream_socket",						abc::test::socket::test_local_stream_socket },
+				{ "test_local_dgram_socket",						abc::test::socket::test_local_dgram_socket },
+				{ "test_tcp_socket_stream_send_file",				abc::test::socket::test_tcp_socket_stream_send_file },
 				{ "test_tcp_socket_stream",							abc::test::socket::test_tcp_socket_stream },
+				{ "test_tcp_socket_stream_bulk",					abc::test::socket::test_tcp_socket_stream_bulk },
+				{ "test_tcp_socket_stream_ring",					abc::test::socket::test_tcp_socket_stream_ring },
+				{ "test_tcp_socket_stream_coalescing",				abc::test::socket::test_tcp_socket_stream_coalescing },
+				{ "test_http_socket_stream_flush_body",				abc::test::socket::test_http_socket_stream_flush_body },
 				{ "test_http_json_socket_stream",					abc::test::socket::test_http_json_socket_stream },
 			} },
 
+			{ "reactor", {
+				{ "test_reactor_tcp_echo",							abc::test::reactor::test_reactor_tcp_echo },
+			} },
+			{ "connection_pool", {
+				{ "test_connection_pool_reuse",						abc::test::connection_pool::test_connection_pool_reuse },
+			} },
+			{ "endpoint", {
+				{ "test_endpoint_keep_alive_broken_response",		abc::test::endpoint::test_endpoint_keep_alive_broken_response },
+			} },
+			{ "queue", {
+				{ "test_mpmc_queue_push_pop",						abc::test::queue::test_mpmc_queue_push_pop },
+				{ "test_mpmc_queue_threads",						abc::test::queue::test_mpmc_queue_threads },
+			} },
+			{ "ring_buffer", {
+				{ "test_ring_buffer_wrap",							abc::test::ring_buffer::test_ring_buffer_wrap },
+			} },
+			{ "scan", {
+				{ "test_scan_kernels",								abc::test::scan::test_scan_kernels },
+			} },
+			{ "send_queue", {
+				{ "test_send_queue_json_backpressure",				abc::test::send_queue::test_send_queue_json_backpressure },
+			} },
+			{ "timer_wheel", {
+				{ "test_timer_wheel_fire",							abc::test::timer_wheel::test_timer_wheel_fire },
+				{ "test_timer_wheel_cascade",						abc::test::timer_wheel::test_timer_wheel_cascade },
+				{ "test_timer_wheel_cancel",						abc::test::timer_wheel::test_timer_wheel_cancel },
+			} },
+#if defined(__cpp_impl_coroutine)
+			{ "coroutine", {
+				{ "test_coroutine_frame_pool",						abc::test::coroutine::test_coroutine_frame_pool },
+				{ "test_coroutine_http_exchange",					abc::test::coroutine::test_coroutine_http_exchange },
+				{ "test_coroutine_exception",						abc::test::coroutine::test_coroutine_exception },
+			} },
+#endif
+
 			{ "post-tests", {
 				{ "test_heap_allocation",							abc::test::heap::test_heap_allocation },
 			} },
@@ -0,0 +1,112 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include <thread>
+#include <atomic>
+
+#include "queue.h"
+#include "heap.h"
+
+
+namespace abc { namespace test { namespace queue {
+
+	bool test_mpmc_queue_push_pop(test_context<abc::test::log>& context) {
+		bool passed = true;
+
+		abc::mpmc_queue<int, 4> queue;
+		int item = 0;
+
+		passed = context.are_equal(queue.try_pop(item), false, 0x103ef, "%d") && passed;
+
+		// Fill the queue up.
+		for (int i = 1; i <= 4; i++) {
+			passed = context.are_equal(queue.try_push(i), true, 0x103f0, "%d") && passed;
+		}
+		passed = context.are_equal(queue.try_push(5), false, 0x103f1, "%d") && passed;
+
+		// Items come out in order, and a popped cell can be reused.
+		passed = context.are_equal(queue.try_pop(item), true, 0x103f2, "%d") && passed;
+		passed = context.are_equal(item, 1, 0x103f3, "%d") && passed;
+		passed = context.are_equal(queue.try_push(5), true, 0x103f4, "%d") && passed;
+
+		for (int i = 2; i <= 5; i++) {
+			queue.pop(item);
+			passed = context.are_equal(item, i, 0x103f5, "%d") && passed;
+		}
+		passed = context.are_equal(queue.try_pop(item), false, 0x103f6, "%d") && passed;
+
+		return passed;
+	}
+
+
+	bool test_mpmc_queue_threads(test_context<abc::test::log>& context) {
+		constexpr int item_count = 10000;
+		bool passed = true;
+
+		abc::mpmc_queue<int, 64> queue;
+		std::atomic_llong sum(0);
+
+		auto produce = [&queue] () {
+			for (int i = 1; i <= item_count; i++) {
+				while (!queue.try_push(i)) {
+					std::this_thread::yield();
+				}
+				queue.notify();
+			}
+		};
+
+		auto consume = [&queue, &sum] () {
+			long long local_sum = 0;
+			for (int i = 1; i <= item_count; i++) {
+				int item;
+				queue.pop(item);
+				local_sum += item;
+			}
+			sum += local_sum;
+		};
+
+		std::thread consumer1(consume);
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x103f7) && passed; // Lambda closure
+		std::thread consumer2(consume);
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x103f8) && passed; // Lambda closure
+		std::thread producer1(produce);
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x103f9) && passed; // Lambda closure
+		std::thread producer2(produce);
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x103fa) && passed; // Lambda closure
+
+		producer1.join();
+		producer2.join();
+		consumer1.join();
+		consumer2.join();
+
+		// Every item was popped exactly once.
+		long long expected_sum = 2LL * item_count * (item_count + 1) / 2;
+		passed = context.are_equal(sum.load(), expected_sum, 0x103fb, "%lld") && passed;
+
+		return passed;
+	}
+
+}}}
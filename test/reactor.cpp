@@ -0,0 +1,188 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include <thread>
+#include <atomic>
+#include <optional>
+#include <cstring>
+
+#include "../src/socket.h"
+
+#include "reactor.h"
+#include "heap.h"
+
+
+namespace abc { namespace test { namespace reactor {
+
+	using reactor_t = abc::reactor<abc::size::_16, abc::test::log>;
+
+
+	class echo_handler : public abc::reactor_handler {
+	public:
+		void start(reactor_t* reactor, abc::tcp_client_socket<abc::test::log>&& socket) {
+			_reactor = reactor;
+			_socket.emplace(std::move(socket));
+			_socket->set_blocking(false);
+			_reactor->add(_socket->handle(), abc::event::readable, this);
+		}
+
+		virtual void on_event(abc::event_t /*events*/) override {
+			char buffer[abc::size::_64];
+
+			// Echo back everything that has been received.
+			while (true) {
+				std::size_t received_size;
+				abc::socket::status_t status = _socket->try_receive(buffer, sizeof(buffer), received_size);
+
+				if (status == abc::socket::status::would_block) {
+					break;
+				}
+
+				if (status == abc::socket::status::closed) {
+					_reactor->remove(_socket->handle());
+					_socket.reset();
+					break;
+				}
+
+				std::size_t sent_size;
+				_socket->try_send(buffer, received_size, sent_size);
+			}
+		}
+
+		bool is_active() const noexcept {
+			return _socket.has_value();
+		}
+
+	private:
+		reactor_t*													_reactor = nullptr;
+		std::optional<abc::tcp_client_socket<abc::test::log>>		_socket;
+	};
+
+
+	template <std::size_t MaxConnections>
+	class listener_handler : public abc::reactor_handler {
+	public:
+		listener_handler(reactor_t* reactor, abc::tcp_server_socket<abc::test::log>* listener)
+			: _reactor(reactor)
+			, _listener(listener) {
+		}
+
+		virtual void on_event(abc::event_t /*events*/) override {
+			// Drain all pending connections.
+			while (_connection_count < MaxConnections) {
+				abc::tcp_client_socket<abc::test::log> client = _listener->accept();
+				if (!client.is_open()) {
+					break;
+				}
+
+				_connections[_connection_count++].start(_reactor, std::move(client));
+			}
+		}
+
+		std::size_t active_count() const noexcept {
+			std::size_t count = 0;
+			for (std::size_t i = 0; i < _connection_count; i++) {
+				if (_connections[i].is_active()) {
+					count++;
+				}
+			}
+
+			return count;
+		}
+
+		std::size_t connection_count() const noexcept {
+			return _connection_count;
+		}
+
+	private:
+		reactor_t*									_reactor;
+		abc::tcp_server_socket<abc::test::log>*		_listener;
+		echo_handler								_connections[MaxConnections];
+		std::size_t									_connection_count = 0;
+	};
+
+
+	bool test_reactor_tcp_echo(test_context<abc::test::log>& context) {
+		const char server_port[] = "31240";
+		const std::size_t client_count = 3;
+		bool passed = true;
+
+		abc::tcp_server_socket<abc::test::log> listener(context.log);
+		listener.bind(server_port);
+		listener.listen(5);
+		listener.set_blocking(false);
+
+		reactor_t reactor(context.log);
+		listener_handler<client_count> listener_handler(&reactor, &listener);
+		reactor.add(listener.handle(), abc::event::readable, &listener_handler);
+
+		std::atomic_size_t passed_count(0);
+		std::thread clients[client_count];
+
+		for (std::size_t i = 0; i < client_count; i++) {
+			clients[i] = std::thread([&context, &passed_count, server_port, i] () {
+				try {
+					abc::tcp_client_socket<abc::test::log> client(context.log);
+					client.connect("localhost", server_port);
+
+					char request[abc::size::_32];
+					std::snprintf(request, sizeof(request), "ping %u", (unsigned)i);
+					std::size_t request_size = std::strlen(request);
+					client.send(request, request_size);
+
+					char response[abc::size::_32];
+					client.receive(response, request_size);
+					response[request_size] = '\0';
+
+					if (context.are_equal(response, request, 0x10366)) {
+						passed_count++;
+					}
+				}
+				catch (const std::exception& ex) {
+					context.log->put_any(abc::category::abc::base, abc::severity::important, 0x10367, "client: EXCEPTION: %s", ex.what());
+				}
+			});
+			passed = abc::test::heap::ignore_heap_allocation(context, 0x10368) && passed; // Lambda closure
+		}
+
+		// Keep dispatching until every client has connected and disconnected.
+		while (listener_handler.connection_count() < client_count || listener_handler.active_count() > 0) {
+			reactor.run_once(100);
+		}
+
+		reactor.stop();
+		passed = context.are_equal(reactor.run_once(0), (std::size_t)0, 0x10369, "%zu") && passed;
+
+		for (std::size_t i = 0; i < client_count; i++) {
+			clients[i].join();
+		}
+
+		passed = context.are_equal(passed_count.load(), client_count, 0x1036a, "%zu") && passed;
+
+		return passed;
+	}
+
+}}}
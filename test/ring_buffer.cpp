@@ -0,0 +1,69 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include <cstring>
+
+#include "ring_buffer.h"
+
+
+namespace abc { namespace test { namespace ring_buffer {
+
+	bool test_ring_buffer_wrap(test_context<abc::test::log>& context) {
+		bool passed = true;
+
+		abc::ring_buffer<abc::test::log> ring(100, context.log);
+		std::size_t capacity = ring.capacity();
+
+		// The capacity is rounded up to whole pages.
+		passed = context.are_equal(capacity >= 100 && capacity % 4096 == 0, true, 0x10409, "%d") && passed;
+		passed = context.are_equal(ring.space_size(), capacity, 0x1040a, "%zu") && passed;
+
+		// Move the read position close to the end.
+		ring.commit(capacity - 4);
+		ring.consume(capacity - 4);
+		passed = context.are_equal(ring.size(), (std::size_t)0, 0x1040b, "%zu") && passed;
+
+		// Write across the end of the memory.
+		const char content[] = "0123456789";
+		std::memcpy(ring.space(), content, sizeof(content));
+		ring.commit(sizeof(content));
+
+		// The bytes read back contiguously, and they are in the memory where they wrapped to.
+		passed = context.are_equal(ring.data(), content, 0x1040c) && passed;
+		passed = context.are_equal(ring.data() + 4 - capacity, content + 4, 0x1040d) && passed;
+
+		// The whole capacity can be filled.
+		passed = context.are_equal(ring.space_size(), capacity - sizeof(content), 0x1040e, "%zu") && passed;
+		ring.commit(ring.space_size());
+		passed = context.are_equal(ring.size(), capacity, 0x1040f, "%zu") && passed;
+
+		ring.consume(capacity);
+		passed = context.are_equal(ring.size(), (std::size_t)0, 0x10410, "%zu") && passed;
+
+		return passed;
+	}
+
+}}}
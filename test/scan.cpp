@@ -0,0 +1,83 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include <algorithm>
+
+#include "scan.h"
+
+
+namespace abc { namespace test { namespace scan {
+
+	using find_t = const char* (*)(const char* begin, const char* end) noexcept;
+	using predicate_t = bool (*)(char ch) noexcept;
+
+
+	// Every kernel the CPU supports must find the same char as a plain scalar loop.
+	bool test_scan_kernels(test_context<abc::test::log>& context) {
+		const find_t finds[] = { abc::scan::find_non_token, abc::scan::find_non_print, abc::scan::find_non_print_or_space };
+		const predicate_t predicates[] = { abc::ascii::http::is_token, abc::ascii::is_abcprint, abc::ascii::is_abcprint_or_space };
+		constexpr std::size_t find_count = sizeof(finds) / sizeof(finds[0]);
+
+		// Mostly header chars, with an occasional delimiter, control char, or non-ascii char.
+		const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.~!#$%&'*+^`|abcdefghijklmnopqrstuvwxyz \t:;,/\"=?()<>[]{}@\\\r\n\x01\x7f\x80\xff";
+		const abc::scan::kernel_t supported_kernel = abc::scan::supported_kernel();
+		bool passed = true;
+
+		char buffer[abc::size::_128];
+		std::uint32_t random = 12345;
+
+		for (abc::scan::kernel_t kernel = abc::scan::kernel::scalar; kernel <= supported_kernel; kernel++) {
+			abc::scan::set_kernel(kernel);
+			passed = context.are_equal(abc::scan::active_kernel(), kernel, 0x10491, "%u") && passed;
+
+			for (std::size_t round = 0; round < abc::size::k1; round++) {
+				// Runs of increasing length, so that the delimiter falls at every position of a vector, and in the scalar tail.
+				std::size_t size = round % sizeof(buffer);
+				std::size_t run_size = (round / 7) % (size + 1);
+
+				for (std::size_t i = 0; i < size; i++) {
+					random = random * 1103515245 + 12345;
+					std::size_t index = (random >> 16) % (sizeof(alphabet) - 1);
+					buffer[i] = i < run_size ? alphabet[index % 26] : alphabet[index];
+				}
+
+				for (std::size_t f = 0; f < find_count; f++) {
+					const char* expected = std::find_if_not(buffer, buffer + size, predicates[f]);
+					const char* actual = finds[f](buffer, buffer + size);
+
+					if (actual != expected) {
+						passed = context.are_equal(actual - buffer, expected - buffer, 0x10492, "%ld") && passed;
+					}
+				}
+			}
+		}
+
+		abc::scan::set_kernel(supported_kernel);
+
+		return passed;
+	}
+
+}}}
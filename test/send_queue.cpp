@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include <cstring>
+#include <sys/socket.h>
+
+#include "../src/json.h"
+#include "../src/buffer_streambuf.h"
+
+#include "send_queue.h"
+
+
+namespace abc { namespace test { namespace send_queue {
+
+	using reactor_t = abc::reactor<abc::size::_16, abc::test::log>;
+	using queue_t = abc::send_queue<abc::tcp_client_socket<abc::test::log>, abc::size::k1, reactor_t, abc::test::log>;
+
+	constexpr std::size_t number_count = 40000;
+
+
+	// Writes a large JSON array, and stops whenever the queue pushes back.
+	class json_producer : public abc::send_queue_handler {
+	public:
+		json_producer(queue_t* queue, abc::test::log* log)
+			: _queue(queue)
+			, _json(queue, log) {
+			_json.put_begin_array();
+		}
+
+		virtual void on_send_ready() override {
+			_ready_count++;
+			produce();
+		}
+
+		void produce() {
+			while (_next < number_count && !_queue->is_backpressured()) {
+				_json.put_number(static_cast<double>(_next++));
+			}
+
+			if (_next == number_count && !_is_done) {
+				_json.put_end_array();
+				_is_done = true;
+			}
+
+			_json.flush();
+		}
+
+		bool is_good() const {
+			return _json.good();
+		}
+
+		std::size_t ready_count() const noexcept {
+			return _ready_count;
+		}
+
+	private:
+		queue_t*										_queue;
+		abc::json_ostream<abc::size::_16, abc::test::log> _json;
+		std::size_t										_next = 0;
+		std::size_t										_ready_count = 0;
+		bool											_is_done = false;
+	};
+
+
+	bool test_send_queue_json_backpressure(test_context<abc::test::log>& context) {
+		const char server_port[] = "31253";
+		bool passed = true;
+
+		// The same JSON written to memory.
+		char expected[4 * abc::size::k64] = { 0 };
+		abc::buffer_streambuf expected_sb(nullptr, 0, 0, expected, 0, sizeof(expected));
+		abc::json_ostream<abc::size::_16, abc::test::log> expected_json(&expected_sb, context.log);
+		expected_json.put_begin_array();
+		for (std::size_t i = 0; i < number_count; i++) {
+			expected_json.put_number(static_cast<double>(i));
+		}
+		expected_json.put_end_array();
+		expected_json.flush();
+		std::size_t expected_size = std::strlen(expected);
+
+		abc::tcp_server_socket<abc::test::log> server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		abc::tcp_client_socket<abc::test::log> client(context.log);
+
+		// Small kernel buffers make the socket refuse bytes well before the whole array is sent.
+		int buffer_size = abc::size::k2;
+		::setsockopt(client.handle(), SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+		client.connect("localhost", server_port);
+
+		abc::tcp_client_socket<abc::test::log> server_client = server.accept();
+		::setsockopt(server_client.handle(), SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+		server_client.set_blocking(false);
+
+		reactor_t reactor(context.log);
+		queue_t queue(&server_client, &reactor, context.log);
+		json_producer producer(&queue, context.log);
+		queue.set_handler(&producer);
+
+		producer.produce();
+		passed = context.are_equal(queue.is_backpressured(), true, 0x10456, "%d") && passed;
+
+		// The producer is resumed from the reactor as the client drains the connection.
+		char received[4 * abc::size::k64];
+		std::size_t received_size = 0;
+		for (std::size_t i = 0; i < abc::size::k64 && received_size < expected_size; i++) {
+			reactor.run_once(10);
+
+			std::size_t size;
+			if (client.try_receive(received + received_size, sizeof(received) - received_size, size) == abc::socket::status::closed) {
+				break;
+			}
+			received_size += size;
+		}
+
+		passed = context.are_equal(received_size, expected_size, 0x10457, "%zu") && passed;
+		passed = context.are_equal(std::memcmp(received, expected, expected_size), 0, 0x10458, "%d") && passed;
+		passed = context.are_equal(producer.is_good(), true, 0x10459, "%d") && passed;
+		passed = context.are_equal(producer.ready_count() > 0, true, 0x1045a, "%d") && passed;
+		passed = context.are_equal(queue.queued_size(), (std::size_t)0, 0x1045b, "%zu") && passed;
+
+		// Close the client side first to avoid TIME_WAIT on the server port.
+		client.close();
+		return passed;
+	}
+
+}}}
@@ -25,9 +25,11 @@ SOFTWARE.
 
 #include <thread>
 #include <cctype>
+#include <net/if.h>
 
 #include "../src/http.h"
 #include "../src/json.h"
+#include "../src/uring.h"
 
 #include "socket.h"
 #include "heap.h"
@@ -89,6 +91,115 @@ namespace abc { namespace test { namespace socket {
 	}
 
 
+	bool test_udp_batch_socket(test_context<abc::test::log>& context) {
+		const char server_port[] = "31243";
+		const char* batch_content[] = { "first", "second", "third" };
+		const char segmented_content[] = "0123456789";
+		const char* expected_content[] = { "first", "second", "third", "0123", "4567", "89" };
+		constexpr std::size_t expected_count = sizeof(expected_content) / sizeof(expected_content[0]);
+		bool passed = true;
+
+		abc::udp_socket server(context.log);
+		server.bind(server_port);
+
+		std::thread client_thread([&context, server_port, batch_content, segmented_content] () {
+			try {
+				abc::udp_socket client(context.log);
+				client.connect("localhost", server_port);
+
+				iovec vector[3];
+				for (std::size_t i = 0; i < 3; i++) {
+					vector[i].iov_base = const_cast<char*>(batch_content[i]);
+					vector[i].iov_len = std::strlen(batch_content[i]);
+				}
+
+				client.send_batch(vector, 3);
+				client.send_segmented(segmented_content, std::strlen(segmented_content), 4);
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x103a9, "client: EXCEPTION: %s", ex.what());
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x103aa) && passed; // Lambda closure
+
+		char content[expected_count][abc::size::_16];
+		iovec vector[expected_count];
+		std::size_t sizes[expected_count];
+		abc::socket::address addresses[expected_count];
+
+		for (std::size_t i = 0; i < expected_count; i++) {
+			vector[i].iov_base = content[i];
+			vector[i].iov_len = sizeof(content[i]) - 1;
+		}
+
+		// The datagrams may arrive over several batches.
+		std::size_t received_count = 0;
+		while (received_count < expected_count) {
+			received_count += server.receive_batch(vector + received_count, sizes + received_count, expected_count - received_count, addresses + received_count);
+		}
+
+		for (std::size_t i = 0; i < expected_count; i++) {
+			content[i][sizes[i]] = '\0';
+			passed = context.are_equal(content[i], expected_content[i], 0x103ab) && passed;
+		}
+
+		passed = context.are_equal(addresses[0].size == addresses[expected_count - 1].size, true, 0x103ac, "%d") && passed;
+		passed = context.are_equal(std::memcmp(&addresses[0].value, &addresses[expected_count - 1].value, addresses[0].size), 0, 0x103ad, "%d") && passed;
+
+		client_thread.join();
+		return passed;
+	}
+
+
+	bool test_udp_multicast_socket(test_context<abc::test::log>& context) {
+		const char group[] = "239.255.0.1";
+		const char group_port[] = "31254";
+		const char first_content[] = "first";
+		const char second_content[] = "second";
+		constexpr std::size_t subscriber_count = 2;
+		bool passed = true;
+
+		// Everything stays on the loopback interface.
+		unsigned loopback_index = ::if_nametoindex("lo");
+
+		abc::udp_socket<abc::test::log> subscribers[subscriber_count] = { abc::udp_socket<abc::test::log>(context.log), abc::udp_socket<abc::test::log>(context.log) };
+		for (std::size_t i = 0; i < subscriber_count; i++) {
+			subscribers[i].set_reuse_port(true);
+			subscribers[i].bind(group_port);
+			subscribers[i].join_group(group, loopback_index);
+		}
+
+		abc::udp_socket publisher(context.log);
+		publisher.connect(group, group_port);
+		publisher.set_multicast_interface(loopback_index);
+		publisher.set_multicast_ttl(1);
+		publisher.set_multicast_loopback(true);
+
+		// A single send reaches every subscriber.
+		publisher.send(first_content, sizeof(first_content) - 1);
+
+		char content[abc::size::_16];
+		for (std::size_t i = 0; i < subscriber_count; i++) {
+			std::size_t received_size = subscribers[i].receive_some(content, sizeof(content) - 1);
+			content[received_size] = '\0';
+			passed = context.are_equal(content, first_content, 0x10469) && passed;
+		}
+
+		// A subscriber that has left the group gets nothing.
+		subscribers[1].leave_group(group, loopback_index);
+		publisher.send(second_content, sizeof(second_content) - 1);
+
+		std::size_t received_size = subscribers[0].receive_some(content, sizeof(content) - 1);
+		content[received_size] = '\0';
+		passed = context.are_equal(content, second_content, 0x1046a) && passed;
+
+		// Loopback delivery happens within send(), so a datagram for subscribers[1] would already be there.
+		passed = context.are_equal(subscribers[1].try_receive(content, sizeof(content), received_size), abc::socket::status::would_block, 0x1046b, "%u") && passed;
+
+		return passed;
+	}
+
+
 	bool test_tcp_sync_socket(test_context<abc::test::log>& context) {
 		const char server_port[] = "31235";
 		const char request_content[] = "Some request content.";
@@ -143,6 +254,337 @@ namespace abc { namespace test { namespace socket {
 	}
 
 
+	bool test_tcp_iovec_socket(test_context<abc::test::log>& context) {
+		const char server_port[] = "31241";
+		const char request_head[] = "Request head. ";
+		const char request_body[] = "Request body.";
+		const char request_content[] = "Request head. Request body.";
+		bool passed = true;
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		std::thread client_thread([&context, server_port, request_head, request_body] () {
+			try {
+				abc::tcp_client_socket client(context.log);
+				client.connect("localhost", server_port);
+
+				// Exclude the terminating '\0' of the head.
+				iovec vector[2];
+				vector[0].iov_base = const_cast<char*>(request_head);
+				vector[0].iov_len = std::strlen(request_head);
+				vector[1].iov_base = const_cast<char*>(request_body);
+				vector[1].iov_len = sizeof(request_body);
+
+				client.send(vector, 2);
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x1038b, "client: EXCEPTION: %s", ex.what());
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x1038c) && passed; // Lambda closure
+
+		abc::tcp_client_socket client = std::move(server.accept());
+
+		// Split differently from how it was sent.
+		char content[sizeof(request_content)];
+		iovec vector[3];
+		vector[0].iov_base = content;
+		vector[0].iov_len = 3;
+		vector[1].iov_base = content + 3;
+		vector[1].iov_len = 20;
+		vector[2].iov_base = content + 23;
+		vector[2].iov_len = sizeof(content) - 23;
+
+		client.receive(vector, 3);
+
+		passed = context.are_equal(content, request_content, 0x1038d) && passed;
+
+		client_thread.join();
+		return passed;
+	}
+
+
+	bool test_tcp_deadline_socket(test_context<abc::test::log>& context) {
+		const char server_port[] = "31245";
+		const char response_content[] = "Late response.";
+		bool passed = true;
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		std::thread client_thread([&passed, &context, server_port, response_content] () {
+			try {
+				abc::tcp_client_socket client(context.log);
+				abc::socket::status_t status = client.connect("localhost", server_port, abc::socket::clock::now() + std::chrono::seconds(5));
+				passed = context.are_equal(status, abc::socket::status::done, 0x103c9, "%u") && passed;
+
+				// The server doesn't send anything until it receives a byte.
+				char content[sizeof(response_content)];
+				status = client.receive(content, sizeof(content), abc::socket::clock::now() + std::chrono::milliseconds(50));
+				passed = context.are_equal(status, abc::socket::status::timeout, 0x103ca, "%u") && passed;
+
+				char ch = 'x';
+				status = client.send(&ch, sizeof(ch), abc::socket::clock::now() + std::chrono::seconds(5));
+				passed = context.are_equal(status, abc::socket::status::done, 0x103cb, "%u") && passed;
+
+				status = client.receive(content, sizeof(content), abc::socket::clock::now() + std::chrono::seconds(5));
+				passed = context.are_equal(status, abc::socket::status::done, 0x103cc, "%u") && passed;
+				passed = context.are_equal(content, response_content, 0x103cd) && passed;
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x103ce, "client: EXCEPTION: %s", ex.what());
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x103cf) && passed; // Lambda closure
+
+		abc::tcp_client_socket client = std::move(server.accept());
+
+		char ch;
+		client.receive(&ch, sizeof(ch));
+		client.send(response_content, sizeof(response_content));
+
+		client_thread.join();
+		return passed;
+	}
+
+
+	bool test_socket_address_cache(test_context<abc::test::log>& context) {
+		const char server_port[] = "31247";
+		bool passed = true;
+
+		// Expiration.
+		sockaddr_in addr = { 0 };
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(80);
+
+		sockaddr_storage cached_addr;
+		socklen_t cached_addr_size;
+
+		abc::address_cache<2> cache(std::chrono::milliseconds(0));
+		cache.put("host", "80", abc::socket::kind::stream, abc::socket::family::ipv4, reinterpret_cast<const sockaddr&>(addr), sizeof(addr));
+		passed = context.are_equal(cache.lookup("host", "80", abc::socket::kind::stream, abc::socket::family::ipv4, cached_addr, cached_addr_size), false, 0x103e0, "%d") && passed;
+		passed = context.are_equal(cache.miss_count(), (std::size_t)1, 0x103e1, "%zu") && passed;
+
+		// Connecting to the same host:port twice resolves it once.
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		std::size_t hit_count = abc::socket::default_address_cache().hit_count();
+
+		abc::tcp_client_socket client1(context.log);
+		client1.connect("localhost", server_port);
+
+		abc::tcp_client_socket client2(context.log);
+		client2.connect("localhost", server_port);
+
+		passed = context.are_equal(abc::socket::default_address_cache().hit_count(), hit_count + 1, 0x103e2, "%zu") && passed;
+
+		return passed;
+	}
+
+
+	bool test_tcp_accept_all_socket(test_context<abc::test::log>& context) {
+		const char server_port[] = "31248";
+		bool passed = true;
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+		server.set_blocking(false);
+
+		abc::socket::handle_t handles[4];
+
+		// Nothing is pending yet.
+		std::size_t count = server.accept_all(handles, 4);
+		passed = context.are_equal(count, (std::size_t)0, 0x103fc, "%zu") && passed;
+
+		abc::tcp_client_socket client1(context.log);
+		client1.connect("localhost", server_port);
+		abc::tcp_client_socket client2(context.log);
+		client2.connect("localhost", server_port);
+		abc::tcp_client_socket client3(context.log);
+		client3.connect("localhost", server_port);
+
+		// The backlog is drained up to max_count, and then the rest of it.
+		count = server.accept_all(handles, 2);
+		passed = context.are_equal(count, (std::size_t)2, 0x103fd, "%zu") && passed;
+		count = server.accept_all(handles + 2, 2);
+		passed = context.are_equal(count, (std::size_t)1, 0x103fe, "%zu") && passed;
+
+		// The accepted handles are non-blocking.
+		int flags = ::fcntl(handles[0], F_GETFL, 0);
+		passed = context.are_equal((flags & O_NONBLOCK) != 0, true, 0x103ff, "%d") && passed;
+
+		// Close the client side first to avoid TIME_WAIT on the server port.
+		client1.close();
+		client2.close();
+		client3.close();
+
+		for (std::size_t i = 0; i < 3; i++) {
+			abc::tcp_client_socket accepted(handles[i], abc::socket::family::ipv4, context.log);
+		}
+
+		return passed;
+	}
+
+
+	bool test_tcp_socket_stats(test_context<abc::test::log>& context) {
+		const char server_port[] = "31250";
+		const char request_content[] = "request";
+		const char response_content[] = "response";
+		bool passed = true;
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		abc::tcp_client_socket client(context.log);
+		client.connect("localhost", server_port);
+
+		abc::tcp_client_socket server_client = std::move(server.accept());
+		abc::socket_stats stats;
+		server_client.set_stats(&stats);
+
+		// Nothing has been sent yet.
+		char buffer[sizeof(response_content)];
+		std::size_t received_size;
+		server_client.try_receive(buffer, sizeof(buffer), received_size);
+
+		client.send(request_content, std::strlen(request_content));
+		server_client.receive(buffer, std::strlen(request_content));
+		server_client.send(response_content, std::strlen(response_content));
+		client.receive(buffer, std::strlen(response_content));
+
+		passed = context.are_equal(stats.would_block_count.load(), (std::uint64_t)1, 0x10415, "%llu") && passed;
+		passed = context.are_equal(stats.receive_calls.load() >= 2, true, 0x10416, "%d") && passed;
+		passed = context.are_equal(stats.bytes_received.load(), (std::uint64_t)std::strlen(request_content), 0x10417, "%llu") && passed;
+		passed = context.are_equal(stats.send_calls.load(), (std::uint64_t)1, 0x10418, "%llu") && passed;
+		passed = context.are_equal(stats.bytes_sent.load(), (std::uint64_t)std::strlen(response_content), 0x10419, "%llu") && passed;
+		passed = context.are_equal(stats.partial_sends.load(), (std::uint64_t)0, 0x1041a, "%llu") && passed;
+
+		// The client socket has no stats attached.
+		passed = context.are_equal(client.stats() == nullptr, true, 0x1041b, "%d") && passed;
+
+		// Close the client side first to avoid TIME_WAIT on the server port.
+		client.close();
+		return passed;
+	}
+
+
+	bool test_local_stream_socket(test_context<abc::test::log>& context) {
+		const char server_path[] = "@abc_test_local_stream";
+		const char request_content[] = "Some request content.";
+		const char response_content[] = "The corresponding response content.";
+		bool passed = true;
+
+		abc::tcp_server_socket server(abc::socket::family::local, context.log);
+		server.bind(server_path);
+		server.listen(5);
+
+		std::thread client_thread([&passed, &context, server_path, request_content, response_content] () {
+			try {
+				abc::tcp_client_socket client(abc::socket::family::local, context.log);
+				client.connect(nullptr, server_path);
+
+				client.send(request_content, sizeof(request_content));
+
+				char content[sizeof(response_content)];
+				client.receive(content, sizeof(content));
+
+				passed = context.are_equal(content, response_content, 0x103e3) && passed;
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x103e4, "client: EXCEPTION: %s", ex.what());
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x103e5) && passed; // Lambda closure
+
+		abc::tcp_client_socket client = std::move(server.accept());
+
+		char content[sizeof(request_content)];
+		client.receive(content, sizeof(content));
+		passed = context.are_equal(content, request_content, 0x103e6) && passed;
+
+		client.send(response_content, sizeof(response_content));
+
+		client_thread.join();
+		return passed;
+	}
+
+
+	bool test_local_dgram_socket(test_context<abc::test::log>& context) {
+		const char server_path[] = "/tmp/abc_test_local_dgram.sock";
+		const char request_content[] = "Some request content.";
+		bool passed = true;
+
+		::unlink(server_path);
+
+		abc::udp_socket server(abc::socket::family::local, context.log);
+		server.bind(server_path);
+
+		abc::udp_socket client(abc::socket::family::local, context.log);
+		client.connect(abc::socket::local_address(server_path));
+		client.send(request_content, sizeof(request_content));
+
+		char content[sizeof(request_content)];
+		server.receive(content, sizeof(content));
+		passed = context.are_equal(content, request_content, 0x103e7) && passed;
+
+		::unlink(server_path);
+		return passed;
+	}
+
+
+	bool test_tcp_socket_stream_send_file(test_context<abc::test::log>& context) {
+		const char server_port[] = "31244";
+		const char response_head[] = "Response head. ";
+		const char file_content[] = "Skipped. File content.";
+		const std::size_t file_offset = 9;
+		const char response_content[] = "Response head. File content.";
+		bool passed = true;
+
+		std::FILE* file = std::tmpfile();
+		std::fputs(file_content, file);
+		std::fflush(file);
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		std::thread client_thread([&passed, &context, server_port, response_content] () {
+			try {
+				abc::tcp_client_socket client(context.log);
+				client.connect("localhost", server_port);
+
+				char content[sizeof(response_content)];
+				client.receive(content, sizeof(content) - 1);
+				content[sizeof(content) - 1] = '\0';
+
+				passed = context.are_equal(content, response_content, 0x103b6) && passed;
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x103b7, "client: EXCEPTION: %s", ex.what());
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x103b8) && passed; // Lambda closure
+
+		abc::tcp_client_socket client = std::move(server.accept());
+		abc::socket_streambuf sb(&client, context.log);
+
+		// The pending head goes out before the file.
+		sb.sputn(response_head, std::strlen(response_head));
+		sb.send_file(fileno(file), file_offset, std::strlen(file_content) - file_offset);
+
+		client_thread.join();
+		std::fclose(file);
+		return passed;
+	}
+
+
 	bool test_tcp_socket_stream(test_context<abc::test::log>& context) {
 		const char server_port[] = "31236";
 		const char request_content[] = "Some request line.";
@@ -193,6 +635,347 @@ namespace abc { namespace test { namespace socket {
 	}
 
 
+	bool test_tcp_socket_stream_bulk(test_context<abc::test::log>& context) {
+		const char server_port[] = "31238";
+		const std::size_t content_size = abc::size::k4 + 3;
+		bool passed = true;
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		std::thread client_thread([&passed, &context, server_port, content_size] () {
+			try {
+				abc::tcp_client_socket client(context.log);
+				client.connect("localhost", server_port);
+
+				// Use odd buffer sizes to cross buffer boundaries in the middle of each write.
+				abc::socket_streambuf<abc::tcp_client_socket<abc::test::log>, abc::test::log, 7, 13> sb(&client, context.log);
+				std::ostream client_out(&sb);
+
+				char content[content_size];
+				for (std::size_t i = 0; i < content_size; i++) {
+					content[i] = static_cast<char>('a' + i % 26);
+				}
+
+				// Small writes go through the buffer. Large writes bypass it.
+				client_out.write(content, 5);
+				client_out.write(content + 5, 11);
+				client_out.write(content + 16, content_size - 16);
+				client_out.flush();
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x10346, "client: EXCEPTION: %s", ex.what());
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x10347) && passed; // Lambda closure
+
+		abc::tcp_client_socket client = std::move(server.accept());
+
+		abc::socket_streambuf<abc::tcp_client_socket<abc::test::log>, abc::test::log, 11, 5> sb(&client, context.log);
+		std::istream client_in(&sb);
+
+		char expected[content_size];
+		for (std::size_t i = 0; i < content_size; i++) {
+			expected[i] = static_cast<char>('a' + i % 26);
+		}
+
+		// Mix single chars, small reads, and a large read.
+		char actual[content_size];
+		actual[0] = client_in.get();
+		client_in.read(actual + 1, 9);
+		client_in.read(actual + 10, content_size - 10);
+
+		passed = context.are_equal(static_cast<std::size_t>(client_in.gcount()), content_size - 10, 0x10348, "%zu") && passed;
+		passed = context.are_equal(actual, expected, content_size, 0x10349) && passed;
+
+		// The client has closed the connection.
+		client_in.get();
+		passed = context.are_equal(client_in.eof(), true, 0x1034a, "%d") && passed;
+
+		client_thread.join();
+		return passed;
+	}
+
+
+	bool test_tcp_uring_socket(test_context<abc::test::log>& context) {
+		const char server_port[] = "31239";
+		const char request_content[] = "Some request content.";
+		const char response_content[] = "The corresponding response content.";
+		bool passed = true;
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		std::thread client_thread([&passed, &context, server_port, request_content, response_content] () {
+			try {
+				abc::tcp_client_socket client(context.log);
+				client.connect("localhost", server_port);
+
+				client.send(request_content, sizeof(request_content));
+
+				char content[sizeof(response_content)];
+				client.receive(content, sizeof(content));
+
+				passed = context.are_equal(content, response_content, 0x10375) && passed;
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x10376, "client: EXCEPTION: %s", ex.what());
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x10377) && passed; // Lambda closure
+
+		abc::uring<abc::size::_16, abc::test::log> ring(context.log);
+		abc::uring_completion completion;
+
+		// Accept
+		server.prepare_accept(ring, 1);
+		ring.submit(1);
+		passed = context.are_equal(ring.get_completion(completion), true, 0x10378, "%d") && passed;
+		passed = context.are_equal(completion.user_data, (std::uint64_t)1, 0x10379, "%llu") && passed;
+
+		abc::tcp_client_socket<abc::test::log> client(completion.result, abc::socket::family::ipv4, context.log);
+		passed = context.are_equal(client.is_open(), true, 0x1037a, "%d") && passed;
+
+		// Receive
+		char content[sizeof(request_content)];
+		std::size_t received_size = 0;
+		while (received_size < sizeof(content)) {
+			client.prepare_receive(ring, content + received_size, sizeof(content) - received_size, 2);
+			ring.submit(1);
+			ring.get_completion(completion);
+
+			if (completion.result <= 0) {
+				break;
+			}
+
+			received_size += completion.result;
+		}
+
+		passed = context.are_equal(content, request_content, 0x1037b) && passed;
+
+		// Send
+		client.prepare_send(ring, response_content, sizeof(response_content), 3);
+		ring.submit(1);
+		passed = context.are_equal(ring.get_completion(completion), true, 0x1037c, "%d") && passed;
+		passed = context.are_equal(completion.result, (std::int32_t)sizeof(response_content), 0x1037d, "%d") && passed;
+		passed = context.are_equal(ring.get_completion(completion), false, 0x1037e, "%d") && passed;
+
+		client_thread.join();
+		return passed;
+	}
+
+
+	// Counts the calls that would result in a syscall.
+	class counting_tcp_client_socket : public abc::tcp_client_socket<abc::test::log> {
+		using base = abc::tcp_client_socket<abc::test::log>;
+
+	public:
+		counting_tcp_client_socket(base&& other)
+			: base(std::move(other)) {
+		}
+
+		void send(const void* buffer, std::size_t size) {
+			send_count++;
+			base::send(buffer, size);
+		}
+
+		void send(const iovec* vector, std::size_t count) {
+			send_count++;
+			base::send(vector, count);
+		}
+
+		std::size_t send_count = 0;
+	};
+
+
+	bool test_tcp_socket_stream_ring(test_context<abc::test::log>& context) {
+		const char server_port[] = "31249";
+		const char first_part[] = "A token that spans ";
+		const char second_part[] = "two sends.";
+		const char content[] = "A token that spans two sends.";
+		bool passed = true;
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		std::thread client_thread([&context, server_port, first_part, second_part] () {
+			try {
+				abc::tcp_client_socket client(context.log);
+				client.connect("localhost", server_port);
+
+				client.send(first_part, std::strlen(first_part));
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				client.send(second_part, std::strlen(second_part));
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x10411, "client: EXCEPTION: %s", ex.what());
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x10412) && passed; // Lambda closure
+
+		abc::tcp_client_socket client = std::move(server.accept());
+		abc::ring_buffer<abc::test::log> ring(1, context.log);
+		abc::socket_streambuf sb(&client, &ring, context.log);
+
+		// Skip a few bytes, so the rest is not at the start of the ring.
+		char skipped[2];
+		sb.sgetn(skipped, sizeof(skipped));
+
+		// The whole token ends up contiguous in the get area, even though it was received in two parts.
+		std::size_t token_size = std::strlen(content) - sizeof(skipped);
+		std::size_t buffered_size = sb.fill_get_area(token_size);
+		passed = context.are_equal(buffered_size, token_size, 0x10413, "%zu") && passed;
+
+		char token[sizeof(content)];
+		sb.sgetn(token, token_size);
+		token[token_size] = '\0';
+		passed = context.are_equal(token, content + sizeof(skipped), 0x10414) && passed;
+
+		client_thread.join();
+		return passed;
+	}
+
+
+	bool test_tcp_socket_stream_coalescing(test_context<abc::test::log>& context) {
+		const char server_port[] = "31252";
+		const char item[] = "item;";
+		const std::size_t item_count = 10;
+		bool passed = true;
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		abc::tcp_client_socket client(context.log);
+		client.connect("localhost", server_port);
+
+		abc::tcp_client_socket server_client = std::move(server.accept());
+		abc::socket_stats stats;
+		server_client.set_stats(&stats);
+
+		abc::socket_streambuf sb(&server_client, context.log);
+		std::ostream out(&sb);
+
+		// Each item is flushed, but the items go out in a single send.
+		sb.set_coalescing(abc::size::k1);
+		sb.begin_response();
+		for (std::size_t i = 0; i < item_count; i++) {
+			out << item;
+			out.flush();
+		}
+		passed = context.are_equal(stats.send_calls.load(), (std::uint64_t)0, 0x1044c, "%llu") && passed;
+
+		sb.end_response();
+		passed = context.are_equal(stats.send_calls.load(), (std::uint64_t)1, 0x1044d, "%llu") && passed;
+
+		char content[sizeof(item) * item_count];
+		client.receive(content, (sizeof(item) - 1) * item_count);
+		content[(sizeof(item) - 1) * item_count] = '\0';
+		passed = context.are_equal(content, "item;item;item;item;item;item;item;item;item;item;", 0x1044e) && passed;
+
+		// With a threshold of 0, each flush sends.
+		sb.set_coalescing(0);
+		sb.begin_response();
+		out << item;
+		out.flush();
+		out << item;
+		out.flush();
+		sb.end_response();
+		passed = context.are_equal(stats.send_calls.load(), (std::uint64_t)3, 0x1044f, "%llu") && passed;
+
+		client.receive(content, (sizeof(item) - 1) * 2);
+
+		// Outside of a response, a flush always sends.
+		sb.set_coalescing(abc::size::k1);
+		out << item;
+		out.flush();
+		passed = context.are_equal(stats.send_calls.load(), (std::uint64_t)4, 0x104d0, "%llu") && passed;
+
+		client.receive(content, sizeof(item) - 1);
+
+		// Close the client side first to avoid TIME_WAIT on the server port.
+		client.close();
+		return passed;
+	}
+
+
+	bool test_http_socket_stream_flush_body(test_context<abc::test::log>& context) {
+		const char server_port[] = "31242";
+		const std::size_t body_size = abc::size::k2;
+		bool passed = true;
+
+		abc::tcp_server_socket server(context.log);
+		server.bind(server_port);
+		server.listen(5);
+
+		std::thread client_thread([&passed, &context, server_port, body_size] () {
+			try {
+				abc::tcp_client_socket client(context.log);
+				client.connect("localhost", server_port);
+
+				abc::socket_streambuf sb(&client, context.log);
+				abc::http_response_istream http(&sb, context.log);
+
+				char buffer[abc::size::_64];
+
+				http.get_protocol(buffer, sizeof(buffer));
+				passed = context.are_equal(buffer, "HTTP/1.1", 0x1038e) && passed;
+
+				http.get_status_code(buffer, sizeof(buffer));
+				passed = context.are_equal(buffer, "200", 0x1038f) && passed;
+
+				http.get_reason_phrase(buffer, sizeof(buffer));
+				passed = context.are_equal(buffer, "OK", 0x10390) && passed;
+
+				http.get_header_name(buffer, sizeof(buffer));
+				passed = context.are_equal(buffer, "Content-Length", 0x10391) && passed;
+
+				http.get_header_value(buffer, sizeof(buffer));
+				passed = context.are_equal(buffer, "2048", 0x10392) && passed;
+
+				http.get_header_name(buffer, sizeof(buffer));
+				passed = context.are_equal(buffer, "", 0x10393) && passed;
+
+				char body[body_size];
+				http.get_body(body, sizeof(body));
+				passed = context.are_equal(http.gcount(), body_size, 0x10394, "%zu") && passed;
+				passed = context.are_equal(body[0] == 'b' && body[body_size - 1] == 'b', true, 0x10395, "%d") && passed;
+			}
+			catch (const std::exception& ex) {
+				context.log->put_any(abc::category::abc::base, abc::severity::important, 0x10396, "client: EXCEPTION: %s", ex.what());
+			}
+		});
+		passed = abc::test::heap::ignore_heap_allocation(context, 0x10397) && passed; // Lambda closure
+
+		counting_tcp_client_socket client(std::move(server.accept()));
+
+		abc::socket_streambuf<counting_tcp_client_socket, abc::test::log> sb(&client, context.log);
+		abc::http_response_ostream http(&sb, context.log);
+		http.set_flush(abc::http::flush::body);
+
+		char body[body_size];
+		std::memset(body, 'b', sizeof(body));
+
+		http.put_protocol("HTTP/1.1");
+		http.put_status_code("200");
+		http.put_reason_phrase("OK");
+		http.put_header_name("Content-Length");
+		http.put_header_value("2048");
+		http.end_headers();
+		passed = context.are_equal(client.send_count, (std::size_t)0, 0x10398, "%zu") && passed;
+
+		// The head and the body go out together.
+		http.put_body(body, sizeof(body));
+		passed = context.are_equal(client.send_count, (std::size_t)1, 0x10399, "%zu") && passed;
+
+		client_thread.join();
+		return passed;
+	}
+
+
 	bool test_http_json_socket_stream(test_context<abc::test::log>& context) {
 		const char server_port[] = "31237";
 		const char protocol[] = "HTTP/1.1";
@@ -33,9 +33,24 @@ SOFTWARE.
 namespace abc { namespace test { namespace socket {
 
 	bool test_udp_sync_socket(test_context<abc::test::log>& context);
+	bool test_udp_batch_socket(test_context<abc::test::log>& context);
+	bool test_udp_multicast_socket(test_context<abc::test::log>& context);
 	bool test_tcp_sync_socket(test_context<abc::test::log>& context);
-
+	bool test_tcp_uring_socket(test_context<abc::test::log>& context);
+	bool test_tcp_iovec_socket(test_context<abc::test::log>& context);
+
+	bool test_tcp_deadline_socket(test_context<abc::test::log>& context);
+	bool test_socket_address_cache(test_context<abc::test::log>& context);
+	bool test_tcp_accept_all_socket(test_context<abc::test::log>& context);
+	bool test_tcp_socket_stats(test_context<abc::test::log>& context);
+	bool test_local_stream_socket(test_context<abc::test::log>& context);
+	bool test_local_dgram_socket(test_context<abc::test::log>& context);
+	bool test_tcp_socket_stream_send_file(test_context<abc::test::log>& context);
 	bool test_tcp_socket_stream(test_context<abc::test::log>& context);
+	bool test_tcp_socket_stream_bulk(test_context<abc::test::log>& context);
+	bool test_tcp_socket_stream_ring(test_context<abc::test::log>& context);
+	bool test_tcp_socket_stream_coalescing(test_context<abc::test::log>& context);
+	bool test_http_socket_stream_flush_body(test_context<abc::test::log>& context);
 	bool test_http_json_socket_stream(test_context<abc::test::log>& context);
 
 }}}
@@ -63,5 +63,33 @@ namespace abc { namespace test { namespace streambuf {
 		return context.are_equal(actual, expected, 0x1003a);
 	}
 
+
+	bool test_buffer_streambuf_span(test_context<abc::test::log>& context) {
+		char content[] = "token1 token2";
+		bool passed = true;
+
+		abc::buffer_streambuf sb(content, 0, std::strlen(content), nullptr, 0, 0);
+		std::istream in(&sb);
+
+		abc::char_span span = sb.peek_span();
+		passed = context.are_equal(span.data == content, true, 0x1046c, "%d") && passed;
+		passed = context.are_equal(span.size, std::strlen(content), 0x1046d, "%zu") && passed;
+
+		// consume() and get() move the same read position.
+		sb.consume(6);
+		passed = context.are_equal((char)in.get(), ' ', 0x1046e, "%c") && passed;
+
+		span = sb.peek_span();
+		passed = context.are_equal(span.data == content + 7, true, 0x1046f, "%d") && passed;
+		passed = context.are_equal(span.size, (std::size_t)6, 0x10470, "%zu") && passed;
+
+		// Consuming past the end stops at the end.
+		sb.consume(100);
+		span = sb.peek_span();
+		passed = context.are_equal(span.size, (std::size_t)0, 0x10471, "%zu") && passed;
+
+		return passed;
+	}
+
 }}}
 
@@ -0,0 +1,132 @@
+/*
+MIT License
+
+Copyright (c) 2018-2020 Zlatko Michailov 
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include "timer_wheel.h"
+
+
+namespace abc { namespace test { namespace timer_wheel {
+
+	class counting_timer_handler : public abc::timer_handler {
+	public:
+		virtual void on_timer() override {
+			count++;
+		}
+
+	public:
+		int count = 0;
+	};
+
+
+	using clock = std::chrono::steady_clock;
+	using ms = std::chrono::milliseconds;
+
+
+	bool test_timer_wheel_fire(test_context<abc::test::log>& context) {
+		bool passed = true;
+
+		abc::timer_wheel<4, abc::test::log> wheel(ms(10), context.log);
+		clock::time_point start = clock::now();
+
+		counting_timer_handler handler1;
+		counting_timer_handler handler2;
+		wheel.schedule(ms(50), &handler1);
+		wheel.schedule(ms(200), &handler2);
+		passed = context.are_equal(wheel.pending_count(), (std::size_t)2, 0x10422, "%zu") && passed;
+		passed = context.are_equal(wheel.next_timeout_ms() >= 0, true, 0x10423, "%d") && passed;
+
+		// Nothing is due yet.
+		passed = context.are_equal(wheel.advance(start + ms(30)), (std::size_t)0, 0x10424, "%zu") && passed;
+		passed = context.are_equal(handler1.count, 0, 0x10425, "%d") && passed;
+
+		// Only the first timer is due.
+		passed = context.are_equal(wheel.advance(start + ms(100)), (std::size_t)1, 0x10426, "%zu") && passed;
+		passed = context.are_equal(handler1.count, 1, 0x10427, "%d") && passed;
+		passed = context.are_equal(handler2.count, 0, 0x10428, "%d") && passed;
+
+		passed = context.are_equal(wheel.advance(start + ms(300)), (std::size_t)1, 0x10429, "%zu") && passed;
+		passed = context.are_equal(handler2.count, 1, 0x1042a, "%d") && passed;
+		passed = context.are_equal(wheel.pending_count(), (std::size_t)0, 0x1042b, "%zu") && passed;
+		passed = context.are_equal(wheel.next_timeout_ms(), -1, 0x1042c, "%d") && passed;
+
+		return passed;
+	}
+
+
+	bool test_timer_wheel_cascade(test_context<abc::test::log>& context) {
+		bool passed = true;
+
+		abc::timer_wheel<4, abc::test::log> wheel(ms(10), context.log);
+		clock::time_point start = clock::now();
+
+		// These land on the second and the third level of the wheel.
+		counting_timer_handler handler1;
+		counting_timer_handler handler2;
+		wheel.schedule(ms(5000), &handler1);
+		wheel.schedule(ms(100000), &handler2);
+
+		passed = context.are_equal(wheel.advance(start + ms(4900)), (std::size_t)0, 0x1042d, "%zu") && passed;
+		passed = context.are_equal(wheel.advance(start + ms(5100)), (std::size_t)1, 0x1042e, "%zu") && passed;
+		passed = context.are_equal(handler1.count, 1, 0x1042f, "%d") && passed;
+
+		passed = context.are_equal(wheel.advance(start + ms(99900)), (std::size_t)0, 0x10430, "%zu") && passed;
+		passed = context.are_equal(wheel.advance(start + ms(100100)), (std::size_t)1, 0x10431, "%zu") && passed;
+		passed = context.are_equal(handler2.count, 1, 0x10432, "%d") && passed;
+
+		return passed;
+	}
+
+
+	bool test_timer_wheel_cancel(test_context<abc::test::log>& context) {
+		bool passed = true;
+
+		abc::timer_wheel<2, abc::test::log> wheel(ms(10), context.log);
+		clock::time_point start = clock::now();
+
+		counting_timer_handler handler;
+		abc::timer_id_t id1 = wheel.schedule(ms(50), &handler);
+		abc::timer_id_t id2 = wheel.schedule(ms(50), &handler);
+
+		// The wheel is full.
+		passed = context.are_equal(wheel.schedule(ms(50), &handler) == abc::timer_id::invalid, true, 0x10433, "%d") && passed;
+
+		passed = context.are_equal(wheel.cancel(id1), true, 0x10434, "%d") && passed;
+		passed = context.are_equal(wheel.cancel(id1), false, 0x10435, "%d") && passed;
+
+		// A canceled timer's entry is reused, but the old id doesn't cancel the new timer.
+		abc::timer_id_t id3 = wheel.schedule(ms(50), &handler);
+		passed = context.are_equal(id3 != abc::timer_id::invalid && id3 != id1, true, 0x10436, "%d") && passed;
+		passed = context.are_equal(wheel.cancel(id1), false, 0x10437, "%d") && passed;
+
+		passed = context.are_equal(wheel.advance(start + ms(100)), (std::size_t)2, 0x10438, "%zu") && passed;
+		passed = context.are_equal(handler.count, 2, 0x10439, "%d") && passed;
+
+		// A fired timer can't be canceled.
+		passed = context.are_equal(wheel.cancel(id2), false, 0x1043a, "%d") && passed;
+
+		return passed;
+	}
+
+}}}